@@ -29,6 +29,7 @@
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <limits>
 
 Table::Table() {}
 
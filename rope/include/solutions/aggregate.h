@@ -0,0 +1,148 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SOLUTIONS_AGGREGATE_H_
+#define SOLUTIONS_AGGREGATE_H_
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Aggregates kept in the nodes of the binary tree ropes. A node derives
+ * from Aggregate::data and has L, R, x and sz fields. pull() recomputes
+ * the node from its children, push() hands the pending updates of the
+ * node down to them; the node itself is always up to date.
+ *
+ * no_aggregate is the default: its data is an empty base and its calls
+ * are empty, so the ropes without range operations are unchanged.
+ */
+struct no_aggregate {
+    static constexpr bool enabled = false;
+
+    struct data { };
+
+    template<class Node>
+    static void pull(Node *v) { }
+
+    template<class Node>
+    static void push(Node *v) { }
+
+    static std::string name() { return ""; }
+};
+
+// Sum and minimum of the range, lazy add of a constant and lazy reverse.
+struct range_aggregate {
+    static constexpr bool enabled = true;
+
+    struct data {
+        long long sum = 0;
+        int min = 0;
+        int add = 0;
+        bool rev = false;
+    };
+
+    template<class Node>
+    static void pull(Node *v) {
+        v->sum = v->x;
+        v->min = v->x;
+        if (v->L) {
+            v->sum += v->L->sum;
+            v->min = std::min(v->min, v->L->min);
+        }
+        if (v->R) {
+            v->sum += v->R->sum;
+            v->min = std::min(v->min, v->R->min);
+        }
+    }
+
+    template<class Node>
+    static void apply_add(Node *v, int delta) {
+        if (!v)
+            return;
+        v->x += delta;
+        v->sum += (long long)delta * v->sz;
+        v->min += delta;
+        v->add += delta;
+    }
+
+    template<class Node>
+    static void apply_reverse(Node *v) {
+        if (!v)
+            return;
+        std::swap(v->L, v->R);
+        v->rev = !v->rev;
+    }
+
+    template<class Node>
+    static void push(Node *v) {
+        if (v->add) {
+            apply_add(v->L, v->add);
+            apply_add(v->R, v->add);
+            v->add = 0;
+        }
+        if (v->rev) {
+            apply_reverse(v->L);
+            apply_reverse(v->R);
+            v->rev = false;
+        }
+    }
+
+    static std::string name() { return "range"; }
+};
+
+// Pushes every pending update down to the leaves, so the tree can be read without them.
+template<class Aggregate, class Node>
+void push_all(Node *root) {
+    if (!Aggregate::enabled || !root)
+        return;
+    std::vector<Node *> stack(1, root);
+    while (!stack.empty()) {
+        Node *v = stack.back();
+        stack.pop_back();
+        Aggregate::push(v);
+        if (v->L)
+            stack.push_back(v->L);
+        if (v->R)
+            stack.push_back(v->R);
+    }
+}
+
+// Appended to the names of the solutions, empty for no_aggregate.
+template<class Aggregate>
+std::string aggregate_suffix() {
+    std::string name = Aggregate::name();
+    return name.empty() ? "" : "," + name;
+}
+
+// The name of a solution with the allocator and aggregate arguments.
+template<class Alloc, class Aggregate>
+std::string aggregate_name(const std::string& name) {
+    std::string args = Alloc::name();
+    if (!Aggregate::name().empty())
+        args += (args.empty() ? "" : ",") + Aggregate::name();
+    return args.empty() ? name : name + "<" + args + ">";
+}
+
+#endif // SOLUTIONS_AGGREGATE_H_
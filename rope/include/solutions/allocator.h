@@ -0,0 +1,264 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Node allocation policies for the ropes.
+ * A rope takes a policy as a template parameter and keeps one
+ * Alloc::pool<node> per instance:
+ *
+ * template<class T>
+ * class pool {
+ * public:
+ *     template<class... Args> T* create(Args&&... args);
+ *     void destroy(T* p);
+ *     // True if the pool frees every node when destroyed.
+ *     static constexpr bool bulk_release;
+ * };
+ */
+
+#ifndef SOLUTIONS_ALLOCATOR_H_
+#define SOLUTIONS_ALLOCATOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Global new and delete for every node.
+struct heap_alloc {
+    template<class T>
+    class pool {
+    public:
+        static constexpr bool bulk_release = false;
+
+        template<class... Args>
+        T* create(Args&&... args) {
+            return new T(std::forward<Args>(args)...);
+        }
+
+        void destroy(T* p) {
+            delete p;
+        }
+    };
+
+    static std::string name() { return ""; }
+};
+
+// Nodes are carved from chunks of 4096, freed nodes are reused first and
+// the chunks are released at once with the pool.
+struct slab_alloc {
+    template<class T>
+    class pool {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "slab_alloc does not run the destructors of the nodes");
+
+        static constexpr std::size_t chunk_size = 4096;
+
+        union slot {
+            slot* next;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type value;
+        };
+
+        std::vector<std::unique_ptr<slot[]>> chunks_;
+        std::size_t used_ = chunk_size;
+        slot* free_ = nullptr;
+    public:
+        static constexpr bool bulk_release = true;
+
+        pool() { }
+        pool(const pool&) = delete;
+
+        template<class... Args>
+        T* create(Args&&... args) {
+            slot* s = free_;
+            if (s) {
+                free_ = s->next;
+            } else {
+                if (used_ == chunk_size) {
+                    chunks_.emplace_back(new slot[chunk_size]);
+                    used_ = 0;
+                }
+                s = &chunks_.back()[used_++];
+            }
+            return new (&s->value) T(std::forward<Args>(args)...);
+        }
+
+        void destroy(T* p) {
+            slot* s = reinterpret_cast<slot*>(p);
+            s->next = free_;
+            free_ = s;
+        }
+    };
+
+    static std::string name() { return "slab"; }
+};
+
+/**
+ * An arena addressed by 32-bit handles instead of pointers, for the
+ * structures that store their links as indices. The nodes live in one
+ * vector, so a handle stays valid while the pointers don't. Handle 0 is
+ * reserved as the null handle, its node is default constructed. Used by
+ * index_treap.
+ */
+template<class T>
+class index_pool {
+    std::vector<T> nodes_;
+    std::vector<std::uint32_t> free_;
+public:
+    typedef std::uint32_t handle;
+    static constexpr handle null = 0;
+
+    index_pool() : nodes_(1) { }
+    index_pool(const index_pool&) = delete;
+    index_pool(index_pool&&) = default;
+
+    template<class... Args>
+    handle create(Args&&... args) {
+        if (!free_.empty()) {
+            handle h = free_.back();
+            free_.pop_back();
+            nodes_[h] = T(std::forward<Args>(args)...);
+            return h;
+        }
+        nodes_.emplace_back(std::forward<Args>(args)...);
+        return nodes_.size() - 1;
+    }
+
+    void destroy(handle h) {
+        free_.push_back(h);
+    }
+
+    T& operator[](handle h) {
+        return nodes_[h];
+    }
+
+    const T& operator[](handle h) const {
+        return nodes_[h];
+    }
+
+    void reserve(std::size_t n) {
+        nodes_.reserve(n + 1);
+    }
+
+    // Frees every node, keeps the memory.
+    void clear() {
+        nodes_.assign(1, T());
+        free_.clear();
+    }
+};
+
+/**
+ * Variable-sized blocks in size classes: a block of class k is
+ * base + k * unit bytes long. Blocks are carved from chunks that the
+ * pool shares with the pools it adopted, so structures that hand nodes
+ * over to each other on split and merge keep the memory of those nodes
+ * alive. Every pool keeps its own free lists.
+ */
+class size_class_pool {
+    static constexpr std::size_t chunk_bytes = 1 << 16;
+
+    struct chunk_store {
+        std::vector<std::unique_ptr<char[]>> chunks;
+    };
+
+    std::size_t base_, unit_;
+    std::vector<void*> free_;
+    std::vector<char*> cursor_, end_;
+    // The first store is where this pool allocates.
+    std::vector<std::shared_ptr<chunk_store>> stores_;
+
+    std::size_t block_size(int cls) const {
+        // The blocks hold pointers and ints, and a free block holds the next one.
+        std::size_t align = alignof(void*);
+        return std::max((base_ + cls * unit_ + align - 1) / align * align, sizeof(void*));
+    }
+public:
+    size_class_pool(std::size_t base, std::size_t unit, int classes)
+        : base_(base),
+          unit_(unit),
+          free_(classes, nullptr),
+          cursor_(classes, nullptr),
+          end_(classes, nullptr),
+          stores_(1, std::make_shared<chunk_store>()) { }
+
+    size_class_pool(const size_class_pool&) = delete;
+    size_class_pool(size_class_pool&&) = default;
+
+    // An empty pool for the same classes, sharing the memory of this one.
+    size_class_pool sibling() const {
+        size_class_pool ret(base_, unit_, free_.size());
+        ret.adopt(*this);
+        return ret;
+    }
+
+    void* allocate(int cls) {
+        if (free_[cls]) {
+            void* p = free_[cls];
+            free_[cls] = *static_cast<void**>(p);
+            return p;
+        }
+        std::size_t size = block_size(cls);
+        if (!cursor_[cls] || cursor_[cls] + size > end_[cls]) {
+            std::size_t bytes = std::max(chunk_bytes / size, std::size_t(1)) * size;
+            stores_[0]->chunks.emplace_back(new char[bytes]);
+            cursor_[cls] = stores_[0]->chunks.back().get();
+            end_[cls] = cursor_[cls] + bytes;
+        }
+        void* p = cursor_[cls];
+        cursor_[cls] += size;
+        return p;
+    }
+
+    void release(void* p, int cls) {
+        *static_cast<void**>(p) = free_[cls];
+        free_[cls] = p;
+    }
+
+    // Keeps the memory of the other pool alive as long as this one.
+    void adopt(const size_class_pool& other) {
+        for (auto& store : other.stores_) {
+            if (std::find(stores_.begin(), stores_.end(), store) == stores_.end())
+                stores_.push_back(store);
+        }
+    }
+};
+
+// Appended to the names of the solutions, empty for heap_alloc.
+template<class Alloc>
+std::string alloc_suffix() {
+    std::string name = Alloc::name();
+    return name.empty() ? "" : "," + name;
+}
+
+// The name of a solution without other template arguments.
+template<class Alloc>
+std::string alloc_name(const std::string& name) {
+    return Alloc::name().empty() ? name : name + "<" + Alloc::name() + ">";
+}
+
+#endif // SOLUTIONS_ALLOCATOR_H_
@@ -24,7 +24,11 @@
 #include <string>
 #include <vector>
 
-class avl_tree {
+#include <solutions/allocator.h>
+#include <solutions/tree_iterator.h>
+
+template<class Alloc = heap_alloc>
+class basic_avl_tree {
     struct node {
         node *L, *R;
         int h, sz;
@@ -36,6 +40,8 @@ class avl_tree {
         }
     };
 
+    typename Alloc::template pool<node> pool;
+
     int node_height(node *v) {
         return v ? v->h : 0;
     }
@@ -143,12 +149,12 @@ class avl_tree {
         if (where == node_sz(v->L)) {
             if (!(v->L)) {
                 node *ret = v->R;
-                delete v;
+                pool.destroy(v);
                 return ret;
             }
             if (!(v->R)) {
                 node *ret = v->L;
-                delete v;
+                pool.destroy(v);
                 return ret;
             }
             node *u = v->R;
@@ -170,30 +176,52 @@ class avl_tree {
         return v;
     }
 
-    void to_vector(node *v, std::vector<int>& w) {
+    void del(node *v) {
         if (!v) return;
-        to_vector(v->L, w);
-        w.push_back(v->x);
-        to_vector(v->R, w);
+        del(v->L);
+        del(v->R);
+        pool.destroy(v);
+    }
+
+    node *build_balanced(const int *first, const int *last) {
+        if (first == last)
+            return nullptr;
+        const int *mid = first + (last - first) / 2;
+        node *v = pool.create(*mid);
+        v->L = build_balanced(first, mid);
+        v->R = build_balanced(mid + 1, last);
+        update(v);
+        return v;
     }
 
     node *root = nullptr;
 
 public:
-    avl_tree() { }
+    typedef tree_iterator<node> iterator;
+
+    basic_avl_tree() { }
 
-    avl_tree(const avl_tree&) = delete;
+    basic_avl_tree(const basic_avl_tree&) = delete;
 
-    ~avl_tree() = default;
+    ~basic_avl_tree() {
+        if (!Alloc::template pool<node>::bulk_release)
+            del(root);
+    }
 
     void insert(int before, int value) {
-        root = insert(root, before, new node(value));
+        root = insert(root, before, pool.create(value));
     }
 
     void erase(int where) {
         root = erase(root, where);
     }
 
+    // Builds a perfectly balanced tree.
+    void build(const int *first, const int *last) {
+        del(root);
+        root = build_balanced(first, last);
+    }
+
     int at(int index) {
         node *v = root;
         while (true) {
@@ -208,12 +236,31 @@ public:
         }
     }
 
+    int size() const {
+        return root ? root->sz : 0;
+    }
+
+    iterator begin() const {
+        return iterator(root);
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    // The output must have room for size() values.
+    void copy_to(int *out) const {
+        copy_tree(root, out);
+    }
+
     operator std::vector<int>() {
-        std::vector<int> w;
-        to_vector(root, w);
+        std::vector<int> w(size());
+        copy_to(w.data());
         return w;
     }
 
-    static std::string name() { return "avl_tree"; }
+    static std::string name() { return alloc_name<Alloc>("avl_tree"); }
 };
 
+typedef basic_avl_tree<> avl_tree;
+
@@ -0,0 +1,315 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SOLUTIONS_BLOCKED_H_
+#define SOLUTIONS_BLOCKED_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * An unrolled list: the values are kept in contiguous blocks of
+ * BlockSize / 2 to 2 * BlockSize values. A block that grows over the
+ * limit is split in halves, one that shrinks under it is merged with a
+ * neighbour and evened out again if the result is too large.
+ *
+ * A position is found by a scan over the block sizes, or by a descent
+ * in a Fenwick tree over them if Indexed is set. The tree is rebuilt
+ * whenever the blocks are split or merged.
+ */
+template<int BlockSize = 512, bool Indexed = false>
+class blocked_rope {
+    static_assert(BlockSize >= 2, "blocked_rope blocks are too small");
+
+    std::vector<std::vector<int> > blocks;
+    std::vector<int> sizes;
+    std::vector<int> fenwick;
+    int log_blocks = 0;
+
+    void rebuild_index() {
+        if (!Indexed)
+            return;
+        int n = sizes.size();
+        fenwick.assign(n + 1, 0);
+        for (int i = 1; i <= n; i++) {
+            fenwick[i] += sizes[i - 1];
+            int up = i + (i & -i);
+            if (up <= n)
+                fenwick[up] += fenwick[i];
+        }
+        for (log_blocks = 0; (2 << log_blocks) <= n; log_blocks++)
+            ;
+    }
+
+    void add(int block, int delta) {
+        sizes[block] += delta;
+        if (!Indexed)
+            return;
+        for (int i = block + 1; i < (int)fenwick.size(); i += i & -i)
+            fenwick[i] += delta;
+    }
+
+    // The block holding the position and the offset in it. An insert may
+    // take the position after the last element.
+    std::pair<int, int> locate(int pos, bool inserting) const {
+        int n = sizes.size();
+        int j = 0;
+        if (Indexed) {
+            for (int step = 1 << log_blocks; step > 0; step >>= 1) {
+                if (j + step <= n && fenwick[j + step] <= pos) {
+                    j += step;
+                    pos -= fenwick[j];
+                }
+            }
+            if (j == n) {
+                j--;
+                pos += sizes[j];
+            }
+        } else if (inserting) {
+            while (j + 1 < n && pos > sizes[j])
+                pos -= sizes[j++];
+        } else {
+            while (pos >= sizes[j])
+                pos -= sizes[j++];
+        }
+        return std::make_pair(j, pos);
+    }
+
+    void new_block(int at, std::vector<int>&& values) {
+        values.reserve(2 * BlockSize + 1);
+        sizes.insert(sizes.begin() + at, values.size());
+        blocks.insert(blocks.begin() + at, std::move(values));
+    }
+
+    void split_block(int j) {
+        std::vector<int>& b = blocks[j];
+        std::vector<int> right(b.begin() + b.size() / 2, b.end());
+        b.resize(b.size() / 2);
+        sizes[j] = b.size();
+        new_block(j + 1, std::move(right));
+    }
+
+    // Merges the block with a neighbour, splits the result again if it is too large.
+    void join_block(int j) {
+        if (j + 1 == (int)blocks.size())
+            j--;
+        std::vector<int>& a = blocks[j];
+        a.insert(a.end(), blocks[j + 1].begin(), blocks[j + 1].end());
+        sizes[j] = a.size();
+        blocks.erase(blocks.begin() + j + 1);
+        sizes.erase(sizes.begin() + j + 1);
+        if (sizes[j] > 3 * BlockSize / 2)
+            split_block(j);
+    }
+
+    // Keeps the blocks at the cut within the limits after split or merge.
+    void fix_boundary(int j) {
+        if (j < 0 || j >= (int)blocks.size())
+            return;
+        if (sizes[j] == 0) {
+            blocks.erase(blocks.begin() + j);
+            sizes.erase(sizes.begin() + j);
+        } else if (sizes[j] < BlockSize / 2 && blocks.size() > 1) {
+            join_block(j);
+        }
+    }
+public:
+    // A block and an offset in it, the end is past the last block.
+    class iterator {
+        const std::vector<int> *block = nullptr;
+        const std::vector<int> *last = nullptr;
+        std::size_t offset = 0;
+
+        void skip_empty() {
+            while (block != last && offset == block->size()) {
+                block++;
+                offset = 0;
+            }
+        }
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef const int& reference;
+
+        iterator() { }
+
+        iterator(const std::vector<int> *_block, const std::vector<int> *_last)
+            : block(_block), last(_last) {
+            skip_empty();
+        }
+
+        reference operator*() const {
+            return (*block)[offset];
+        }
+
+        pointer operator->() const {
+            return &(*block)[offset];
+        }
+
+        iterator& operator++() {
+            offset++;
+            skip_empty();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        bool operator==(const iterator& other) const {
+            return block == other.block && offset == other.offset;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    blocked_rope() { }
+
+    blocked_rope(const blocked_rope&) = delete;
+    blocked_rope(blocked_rope&&) = default;
+
+    ~blocked_rope() = default;
+
+    void insert(int before, int value) {
+        if (blocks.empty()) {
+            new_block(0, std::vector<int>(1, value));
+            rebuild_index();
+            return;
+        }
+        std::pair<int, int> p = locate(before, true);
+        std::vector<int>& b = blocks[p.first];
+        b.insert(b.begin() + p.second, value);
+        add(p.first, 1);
+        if (sizes[p.first] > 2 * BlockSize) {
+            split_block(p.first);
+            rebuild_index();
+        }
+    }
+
+    void erase(int where) {
+        std::pair<int, int> p = locate(where, false);
+        std::vector<int>& b = blocks[p.first];
+        b.erase(b.begin() + p.second);
+        add(p.first, -1);
+        if (sizes[p.first] < BlockSize / 2 && (sizes[p.first] == 0 || blocks.size() > 1)) {
+            fix_boundary(p.first);
+            rebuild_index();
+        }
+    }
+
+    void build(const int *first, const int *last) {
+        blocks.clear();
+        sizes.clear();
+        for (; first != last; first += std::min<std::ptrdiff_t>(BlockSize, last - first))
+            new_block(blocks.size(), std::vector<int>(first, first + std::min<std::ptrdiff_t>(BlockSize, last - first)));
+        rebuild_index();
+    }
+
+    int at(int index) {
+        std::pair<int, int> p = locate(index, false);
+        return blocks[p.first][p.second];
+    }
+
+    // Linear in the number of blocks.
+    std::pair<blocked_rope, blocked_rope> split(int left) {
+        blocked_rope lt, rt;
+        if (!blocks.empty()) {
+            std::pair<int, int> p = locate(left, true);
+            std::vector<int>& b = blocks[p.first];
+            std::vector<int> tail(b.begin() + p.second, b.end());
+            b.resize(p.second);
+            sizes[p.first] = b.size();
+            for (int i = 0; i <= p.first; i++)
+                lt.new_block(lt.blocks.size(), std::move(blocks[i]));
+            rt.new_block(0, std::move(tail));
+            for (int i = p.first + 1; i < (int)blocks.size(); i++)
+                rt.new_block(rt.blocks.size(), std::move(blocks[i]));
+            lt.fix_boundary(lt.blocks.size() - 1);
+            rt.fix_boundary(0);
+        }
+        blocks.clear();
+        sizes.clear();
+        lt.rebuild_index();
+        rt.rebuild_index();
+        rebuild_index();
+        return std::make_pair(std::move(lt), std::move(rt));
+    }
+
+    static blocked_rope merge(blocked_rope&& lt, blocked_rope&& rt) {
+        blocked_rope ret(std::move(lt));
+        int cut = ret.blocks.size();
+        for (auto& b : rt.blocks)
+            ret.new_block(ret.blocks.size(), std::move(b));
+        rt.blocks.clear();
+        rt.sizes.clear();
+        ret.fix_boundary(cut);
+        if (cut > 0 && cut <= (int)ret.blocks.size())
+            ret.fix_boundary(cut - 1);
+        ret.rebuild_index();
+        return ret;
+    }
+
+    // Linear in the number of blocks.
+    int size() const {
+        int ret = 0;
+        for (int s : sizes)
+            ret += s;
+        return ret;
+    }
+
+    iterator begin() const {
+        return iterator(blocks.data(), blocks.data() + blocks.size());
+    }
+
+    iterator end() const {
+        return iterator(blocks.data() + blocks.size(), blocks.data() + blocks.size());
+    }
+
+    // The output must have room for size() values.
+    void copy_to(int *out) const {
+        for (auto& b : blocks)
+            out = std::copy(b.begin(), b.end(), out);
+    }
+
+    operator std::vector<int>() {
+        std::vector<int> ret(size());
+        copy_to(ret.data());
+        return ret;
+    }
+
+    static std::string name() {
+        return "blocked_rope<" + std::to_string(BlockSize) + (Indexed ? ",indexed>" : ">");
+    }
+};
+
+#endif
@@ -0,0 +1,464 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SOLUTIONS_BTREE_H_
+#define SOLUTIONS_BTREE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * A B+-tree rope. Leaves hold up to LeafSize values in a row, inner
+ * nodes hold up to Fanout children with the sizes of their subtrees,
+ * so an access touches about log_Fanout(n / LeafSize) nodes and a scan
+ * reads whole leaves. A node that drops below half full after an erase
+ * is merged with a sibling or takes over some of its entries.
+ */
+template<int LeafSize = 256, int Fanout = 32>
+class btree_rope {
+    static_assert(LeafSize >= 4 && Fanout >= 4, "btree_rope nodes are too small");
+
+    struct node { };
+
+    struct leaf : node {
+        int n = 0;
+        int values[LeafSize];
+    };
+
+    struct inner : node {
+        int n = 0;
+        int cnt[Fanout];
+        node *child[Fanout];
+    };
+
+    // The root is a leaf at height 0.
+    node *root;
+    int height = 0;
+
+    static leaf *as_leaf(node *v) {
+        return static_cast<leaf *>(v);
+    }
+
+    static inner *as_inner(node *v) {
+        return static_cast<inner *>(v);
+    }
+
+    static int total(node *v, int level) {
+        if (level == 0)
+            return as_leaf(v)->n;
+        inner *u = as_inner(v);
+        int ret = 0;
+        for (int i = 0; i < u->n; i++)
+            ret += u->cnt[i];
+        return ret;
+    }
+
+    static void del(node *v, int level) {
+        if (level == 0) {
+            delete as_leaf(v);
+            return;
+        }
+        inner *u = as_inner(v);
+        for (int i = 0; i < u->n; i++)
+            del(u->child[i], level - 1);
+        delete u;
+    }
+
+    static void put_entry(inner *u, int at, int cnt, node *child) {
+        std::memmove(u->cnt + at + 1, u->cnt + at, (u->n - at) * sizeof(int));
+        std::memmove(u->child + at + 1, u->child + at, (u->n - at) * sizeof(node *));
+        u->cnt[at] = cnt;
+        u->child[at] = child;
+        u->n++;
+    }
+
+    static void remove_entry(inner *u, int at) {
+        std::memmove(u->cnt + at, u->cnt + at + 1, (u->n - at - 1) * sizeof(int));
+        std::memmove(u->child + at, u->child + at + 1, (u->n - at - 1) * sizeof(node *));
+        u->n--;
+    }
+
+    // Moves the last k entries of a to the front of b.
+    static void shift_right(leaf *a, leaf *b, int k) {
+        std::memmove(b->values + k, b->values, b->n * sizeof(int));
+        std::memcpy(b->values, a->values + a->n - k, k * sizeof(int));
+        a->n -= k;
+        b->n += k;
+    }
+
+    static void shift_right(inner *a, inner *b, int k) {
+        std::memmove(b->cnt + k, b->cnt, b->n * sizeof(int));
+        std::memmove(b->child + k, b->child, b->n * sizeof(node *));
+        std::memcpy(b->cnt, a->cnt + a->n - k, k * sizeof(int));
+        std::memcpy(b->child, a->child + a->n - k, k * sizeof(node *));
+        a->n -= k;
+        b->n += k;
+    }
+
+    // Moves the first k entries of b to the end of a.
+    static void shift_left(leaf *a, leaf *b, int k) {
+        std::memcpy(a->values + a->n, b->values, k * sizeof(int));
+        std::memmove(b->values, b->values + k, (b->n - k) * sizeof(int));
+        a->n += k;
+        b->n -= k;
+    }
+
+    static void shift_left(inner *a, inner *b, int k) {
+        std::memcpy(a->cnt + a->n, b->cnt, k * sizeof(int));
+        std::memcpy(a->child + a->n, b->child, k * sizeof(node *));
+        std::memmove(b->cnt, b->cnt + k, (b->n - k) * sizeof(int));
+        std::memmove(b->child, b->child + k, (b->n - k) * sizeof(node *));
+        a->n += k;
+        b->n -= k;
+    }
+
+    // Merges the children at j and j + 1 if they fit into one, evens them out otherwise.
+    template<class T, int Capacity>
+    static void rebalance(inner *u, int j, int level) {
+        T *a = static_cast<T *>(u->child[j]);
+        T *b = static_cast<T *>(u->child[j + 1]);
+        if (a->n + b->n <= Capacity) {
+            shift_left(a, b, b->n);
+            u->cnt[j] += u->cnt[j + 1];
+            delete b;
+            remove_entry(u, j + 1);
+            return;
+        }
+        int half = (a->n + b->n) / 2;
+        if (a->n < half)
+            shift_left(a, b, half - a->n);
+        else
+            shift_right(a, b, a->n - half);
+        u->cnt[j] = total(a, level);
+        u->cnt[j + 1] = total(b, level);
+    }
+
+    static void fix_child(inner *u, int j, int level) {
+        if (u->n < 2)
+            return;
+        if (level == 0) {
+            if (as_leaf(u->child[j])->n < LeafSize / 2)
+                rebalance<leaf, LeafSize>(u, j + 1 < u->n ? j : j - 1, level);
+        } else {
+            if (as_inner(u->child[j])->n < Fanout / 2)
+                rebalance<inner, Fanout>(u, j + 1 < u->n ? j : j - 1, level);
+        }
+    }
+
+    // Returns the new right sibling if the node was split.
+    static node *insert(node *v, int level, int pos, int value) {
+        if (level == 0) {
+            leaf *l = as_leaf(v);
+            leaf *r = nullptr;
+            if (l->n == LeafSize) {
+                r = new leaf;
+                shift_right(l, r, LeafSize / 2);
+                if (pos > l->n) {
+                    pos -= l->n;
+                    l = r;
+                }
+            }
+            std::memmove(l->values + pos + 1, l->values + pos, (l->n - pos) * sizeof(int));
+            l->values[pos] = value;
+            l->n++;
+            return r;
+        }
+
+        inner *u = as_inner(v);
+        int j = 0;
+        while (j + 1 < u->n && pos > u->cnt[j])
+            pos -= u->cnt[j++];
+        node *split = insert(u->child[j], level - 1, pos, value);
+        u->cnt[j]++;
+        if (!split)
+            return nullptr;
+
+        int split_cnt = total(split, level - 1);
+        u->cnt[j] -= split_cnt;
+        inner *r = nullptr;
+        j++;
+        if (u->n == Fanout) {
+            r = new inner;
+            shift_right(u, r, Fanout / 2);
+            if (j > u->n) {
+                j -= u->n;
+                u = r;
+            }
+        }
+        put_entry(u, j, split_cnt, split);
+        return r;
+    }
+
+    static void erase(node *v, int level, int pos) {
+        if (level == 0) {
+            leaf *l = as_leaf(v);
+            std::memmove(l->values + pos, l->values + pos + 1, (l->n - pos - 1) * sizeof(int));
+            l->n--;
+            return;
+        }
+        inner *u = as_inner(v);
+        int j = 0;
+        while (pos >= u->cnt[j])
+            pos -= u->cnt[j++];
+        erase(u->child[j], level - 1, pos);
+        u->cnt[j]--;
+        fix_child(u, j, level - 1);
+    }
+
+    // The recursion is only as deep as the tree is high.
+    static int *copy_to(node *v, int level, int *out) {
+        if (level == 0) {
+            leaf *l = as_leaf(v);
+            return std::copy(l->values, l->values + l->n, out);
+        }
+        inner *u = as_inner(v);
+        for (int i = 0; i < u->n; i++)
+            out = copy_to(u->child[i], level - 1, out);
+        return out;
+    }
+
+    // Builds the tree from the values with the nodes filled evenly.
+    template<class Iterator>
+    void assign(Iterator first, Iterator last) {
+        del(root, height);
+        height = 0;
+        std::size_t n = last - first;
+        std::size_t leaves = (n + LeafSize - 1) / LeafSize;
+        if (leaves < 2) {
+            leaf *l = new leaf;
+            l->n = n;
+            std::copy(first, last, l->values);
+            root = l;
+            return;
+        }
+
+        std::vector<node *> level;
+        std::vector<int> counts;
+        for (std::size_t i = 0; i != leaves; i++) {
+            leaf *l = new leaf;
+            l->n = n * (i + 1) / leaves - n * i / leaves;
+            std::copy(first, first + l->n, l->values);
+            first += l->n;
+            level.push_back(l);
+            counts.push_back(l->n);
+        }
+        while (level.size() > 1) {
+            std::size_t m = level.size();
+            std::size_t parents = (m + Fanout - 1) / Fanout;
+            std::vector<node *> up;
+            std::vector<int> up_counts;
+            for (std::size_t i = 0, k = 0; i != parents; i++) {
+                inner *u = new inner;
+                int cnt = 0;
+                for (std::size_t end = m * (i + 1) / parents; k != end; k++) {
+                    u->cnt[u->n] = counts[k];
+                    u->child[u->n++] = level[k];
+                    cnt += counts[k];
+                }
+                up.push_back(u);
+                up_counts.push_back(cnt);
+            }
+            level.swap(up);
+            counts.swap(up_counts);
+            height++;
+        }
+        root = level[0];
+    }
+public:
+    // Walks the leaves in order with the path from the root on a stack.
+    class iterator {
+        std::vector<std::pair<inner *, int> > path;
+        leaf *l = nullptr;
+        int offset = 0;
+        int height = 0;
+
+        void descend(node *v) {
+            for (int level = height - (int)path.size(); level > 0; level--) {
+                path.push_back(std::make_pair(as_inner(v), 0));
+                v = as_inner(v)->child[0];
+            }
+            l = as_leaf(v);
+            offset = 0;
+        }
+
+        void skip_empty() {
+            while (l && offset == l->n) {
+                while (!path.empty() && path.back().second + 1 == path.back().first->n)
+                    path.pop_back();
+                if (path.empty()) {
+                    l = nullptr;
+                    offset = 0;
+                    return;
+                }
+                path.back().second++;
+                descend(path.back().first->child[path.back().second]);
+            }
+        }
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef const int& reference;
+
+        iterator() { }
+
+        iterator(node *root, int _height) : height(_height) {
+            descend(root);
+            skip_empty();
+        }
+
+        reference operator*() const {
+            return l->values[offset];
+        }
+
+        pointer operator->() const {
+            return l->values + offset;
+        }
+
+        iterator& operator++() {
+            offset++;
+            skip_empty();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        bool operator==(const iterator& other) const {
+            return l == other.l && offset == other.offset;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    btree_rope() : root(new leaf) { }
+
+    btree_rope(const btree_rope&) = delete;
+
+    btree_rope(btree_rope&& other) : root(other.root), height(other.height) {
+        other.root = new leaf;
+        other.height = 0;
+    }
+
+    ~btree_rope() {
+        del(root, height);
+    }
+
+    void insert(int before, int value) {
+        node *split = insert(root, height, before, value);
+        if (split) {
+            inner *u = new inner;
+            u->n = 2;
+            u->cnt[0] = total(root, height);
+            u->child[0] = root;
+            u->cnt[1] = total(split, height);
+            u->child[1] = split;
+            root = u;
+            height++;
+        }
+    }
+
+    void erase(int where) {
+        erase(root, height, where);
+        while (height > 0 && as_inner(root)->n == 1) {
+            node *child = as_inner(root)->child[0];
+            delete as_inner(root);
+            root = child;
+            height--;
+        }
+    }
+
+    void build(const int *first, const int *last) {
+        assign(first, last);
+    }
+
+    int at(int index) {
+        node *v = root;
+        for (int level = height; level > 0; level--) {
+            inner *u = as_inner(v);
+            int j = 0;
+            while (index >= u->cnt[j])
+                index -= u->cnt[j++];
+            v = u->child[j];
+        }
+        return as_leaf(v)->values[index];
+    }
+
+    // Split and merge rebuild the trees from the values, in linear time.
+    std::pair<btree_rope, btree_rope> split(int left) {
+        std::vector<int> w = *this;
+        btree_rope lt, rt;
+        lt.assign(w.begin(), w.begin() + left);
+        rt.assign(w.begin() + left, w.end());
+        return std::make_pair(std::move(lt), std::move(rt));
+    }
+
+    static btree_rope merge(btree_rope&& lt, btree_rope&& rt) {
+        std::vector<int> w = lt;
+        std::vector<int> r = rt;
+        w.insert(w.end(), r.begin(), r.end());
+        btree_rope ret;
+        ret.assign(w.begin(), w.end());
+        return ret;
+    }
+
+    int size() const {
+        return total(root, height);
+    }
+
+    iterator begin() const {
+        return iterator(root, height);
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    // The output must have room for size() values.
+    void copy_to(int *out) const {
+        copy_to(root, height, out);
+    }
+
+    operator std::vector<int>() {
+        std::vector<int> w(size());
+        copy_to(w.data());
+        return w;
+    }
+
+    static std::string name() {
+        return "btree_rope<" + std::to_string(LeafSize) + "," + std::to_string(Fanout) + ">";
+    }
+};
+
+#endif
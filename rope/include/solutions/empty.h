@@ -26,6 +26,8 @@
 
 class empty {
 public:
+    typedef const int *iterator;
+
     empty() { }
     empty(const empty&) = delete;
     ~empty() = default;
@@ -34,10 +36,38 @@ public:
 
     void erase(int where) {}
 
+    void build(const int *first, const int *last) {}
+
     int at(int index) {
         return 0;
     }
 
+    int size() const {
+        return 0;
+    }
+
+    iterator begin() const {
+        return nullptr;
+    }
+
+    iterator end() const {
+        return nullptr;
+    }
+
+    void copy_to(int *out) const {}
+
+    long long sum(int l, int r) {
+        return 0;
+    }
+
+    int min(int l, int r) {
+        return 0;
+    }
+
+    void add(int l, int r, int delta) {}
+
+    void reverse(int l, int r) {}
+
     operator std::vector<int>() {
         return std::vector<int>();
     }
@@ -0,0 +1,302 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SOLUTIONS_INDEX_TREAP_H_
+#define SOLUTIONS_INDEX_TREAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <solutions/allocator.h>
+#include <solutions/treap.h>
+
+/**
+ * The treap of olymp_treap with whole nodes kept in an index_pool and
+ * linked by its 32-bit handles. A node takes 20 bytes against 32 with
+ * pointers; unlike soa_treap the value shares the node with the fields
+ * used on the way down. Handle 0 is the null node of size 0.
+ */
+template<class random_eng>
+class index_treap {
+    struct node {
+        int x = 0, y = 0;
+        int sz = 0;
+        std::uint32_t L = 0, R = 0;
+
+        node() { }
+        node(int _x, int _y) : x(_x), y(_y), sz(1) { }
+    };
+
+    typedef typename index_pool<node>::handle id;
+
+    random_eng rnd;
+    index_pool<node> nodes;
+    id root = 0;
+
+    void update(id v) {
+        nodes[v].sz = 1 + nodes[nodes[v].L].sz + nodes[nodes[v].R].sz;
+    }
+
+    void split(id v, int skip, id& left, id& right) {
+        if (!v) {
+            left = right = 0;
+            return;
+        }
+        node& n = nodes[v];
+        if (nodes[n.L].sz >= skip) {
+            split(n.L, skip, left, n.L);
+            update(v);
+            right = v;
+        } else {
+            split(n.R, skip - nodes[n.L].sz - 1, n.R, right);
+            update(v);
+            left = v;
+        }
+    }
+
+    id merge(id left, id right) {
+        if (!left)
+            return right;
+        if (!right)
+            return left;
+        if (nodes[left].y < nodes[right].y) {
+            id r = merge(nodes[left].R, right);
+            nodes[left].R = r;
+            update(left);
+            return left;
+        } else {
+            id l = merge(left, nodes[right].L);
+            nodes[right].L = l;
+            update(right);
+            return right;
+        }
+    }
+
+    // Copies a subtree of another treap, keeping the priorities.
+    id copy_from(const index_treap& other, id v) {
+        if (!v)
+            return 0;
+        id l = copy_from(other, other.nodes[v].L);
+        id r = copy_from(other, other.nodes[v].R);
+        id u = nodes.create(other.nodes[v].x, other.nodes[v].y);
+        nodes[u].L = l;
+        nodes[u].R = r;
+        nodes[u].sz = other.nodes[v].sz;
+        return u;
+    }
+
+    void release(id v) {
+        if (!v)
+            return;
+        release(nodes[v].L);
+        release(nodes[v].R);
+        nodes.destroy(v);
+    }
+
+    int calc_sizes(id v) {
+        if (!v)
+            return 0;
+        int sz = 1 + calc_sizes(nodes[v].L);
+        sz += calc_sizes(nodes[v].R);
+        nodes[v].sz = sz;
+        return sz;
+    }
+public:
+    // In-order iterator with the path to the current node on a stack.
+    class iterator {
+        const index_pool<node> *nodes = nullptr;
+        std::vector<id> stack;
+
+        void descend(id v) {
+            for (; v; v = (*nodes)[v].L)
+                stack.push_back(v);
+        }
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef const int& reference;
+
+        iterator() { }
+
+        iterator(const index_pool<node> *_nodes, id root) : nodes(_nodes) {
+            descend(root);
+        }
+
+        reference operator*() const {
+            return (*nodes)[stack.back()].x;
+        }
+
+        pointer operator->() const {
+            return &(*nodes)[stack.back()].x;
+        }
+
+        iterator& operator++() {
+            id v = stack.back();
+            stack.pop_back();
+            descend((*nodes)[v].R);
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        bool operator==(const iterator& other) const {
+            if (stack.empty() || other.stack.empty())
+                return stack.empty() == other.stack.empty();
+            return stack.back() == other.stack.back();
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    index_treap()
+        : rnd(179) { }
+    index_treap(const index_treap&) = delete;
+    index_treap(index_treap&&) = default;
+    ~index_treap() = default;
+
+    void insert(int before, int value) {
+        id left, right;
+        split(root, before, left, right);
+        id mid = nodes.create(value, rnd());
+        right = merge(mid, right);
+        root = merge(left, right);
+    }
+
+    void erase(int which) {
+        id left, mid, right;
+        split(root, which, left, right);
+        split(right, 1, mid, right);
+        nodes.destroy(mid);
+        root = merge(left, right);
+    }
+
+    // The right part is copied out, so this is linear in its size. Leaves this treap empty.
+    std::pair<index_treap, index_treap> split(int left) {
+        id l, r;
+        split(root, left, l, r);
+        index_treap rt;
+        rt.root = rt.copy_from(*this, r);
+        release(r);
+        root = l;
+        index_treap lt(std::move(*this));
+        nodes.clear();
+        root = 0;
+        return std::make_pair(std::move(lt), std::move(rt));
+    }
+
+    // Linear in the size of rt, whose nodes are copied into lt.
+    static index_treap merge(index_treap&& lt, index_treap&& rt) {
+        index_treap ret(std::move(lt));
+        lt.nodes.clear();
+        lt.root = 0;
+        id r = ret.copy_from(rt, rt.root);
+        ret.root = ret.merge(ret.root, r);
+        return ret;
+    }
+
+    // Builds the Cartesian tree of the values on a stack in linear time.
+    void build(const int *first, const int *last) {
+        nodes.clear();
+        nodes.reserve(last - first);
+        std::vector<id> stack;
+        for (; first != last; first++) {
+            id v = nodes.create(*first, rnd());
+            id prev = 0;
+            while (!stack.empty() && nodes[stack.back()].y > nodes[v].y) {
+                prev = stack.back();
+                stack.pop_back();
+            }
+            nodes[v].L = prev;
+            if (!stack.empty())
+                nodes[stack.back()].R = v;
+            stack.push_back(v);
+        }
+        root = stack.empty() ? 0 : stack[0];
+        calc_sizes(root);
+    }
+
+    int at(int i) {
+        id v = root;
+        while (true) {
+            const node& n = nodes[v];
+            if (i < nodes[n.L].sz) {
+                v = n.L;
+            } else if (i == nodes[n.L].sz) {
+                return n.x;
+            } else {
+                i -= nodes[n.L].sz + 1;
+                v = n.R;
+            }
+        }
+    }
+
+    int size() const {
+        return nodes[root].sz;
+    }
+
+    iterator begin() const {
+        return iterator(&nodes, root);
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    // The output must have room for size() values.
+    void copy_to(int *out) const {
+        std::vector<id> stack;
+        id v = root;
+        while (v || !stack.empty()) {
+            for (; v; v = nodes[v].L)
+                stack.push_back(v);
+            v = stack.back();
+            stack.pop_back();
+            *out++ = nodes[v].x;
+            v = nodes[v].R;
+        }
+    }
+
+    operator std::vector<int>() {
+        std::vector<int> ret(size());
+        copy_to(ret.data());
+        return ret;
+    }
+
+    static std::string name() {
+        return "index_treap<" + rnd_eng_name<random_eng>() + ">";
+    }
+};
+
+#endif
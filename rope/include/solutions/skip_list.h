@@ -0,0 +1,331 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SOLUTIONS_SKIP_LIST_H_
+#define SOLUTIONS_SKIP_LIST_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <solutions/allocator.h>
+#include <solutions/treap.h>
+
+/**
+ * An indexable skip list. Every forward link carries its span: the
+ * distance in positions to the node it points to, or to the position
+ * after the last element if it is null. A node is promoted to the next
+ * level with probability 1/4, and a node of height h takes one block
+ * of class h from a size_class_pool.
+ *
+ * Split and merge relink O(max_level) pointers; the two lists share
+ * the chunks of their nodes.
+ */
+template<class random_eng>
+class skip_list {
+    static constexpr int max_level = 16;
+
+    struct node;
+
+    struct link {
+        node *next;
+        int span;
+    };
+
+    struct node {
+        int value;
+        int height;
+
+        link *links() {
+            return reinterpret_cast<link *>(this + 1);
+        }
+    };
+
+    random_eng rnd;
+    size_class_pool pool;
+    // The head is at position 0 and has max_level links, levels of them in use.
+    node *head;
+    int levels = 1;
+    int length = 0;
+
+    node *new_node(int value, int height) {
+        node *v = static_cast<node *>(pool.allocate(height));
+        v->value = value;
+        v->height = height;
+        return v;
+    }
+
+    node *new_head() {
+        node *h = new_node(0, max_level);
+        for (int i = 0; i < max_level; i++)
+            h->links()[i] = link{ nullptr, 1 };
+        return h;
+    }
+
+    int random_height() {
+        unsigned bits = rnd();
+        int height = 1;
+        while (height < max_level && (bits & 3) == 0) {
+            bits >>= 2;
+            height++;
+        }
+        return height;
+    }
+
+    // Finds the last node at or before the position on every level in use.
+    void find(int pos, node **update, int *rank) {
+        node *v = head;
+        int traversed = 0;
+        for (int i = levels - 1; i >= 0; i--) {
+            link *l = v->links() + i;
+            while (l->next && traversed + l->span <= pos) {
+                traversed += l->span;
+                v = l->next;
+                l = v->links() + i;
+            }
+            update[i] = v;
+            rank[i] = traversed;
+        }
+    }
+
+    explicit skip_list(size_class_pool&& p)
+        : rnd(179),
+          pool(std::move(p)),
+          head(new_head()) { }
+public:
+    // Follows the links of the bottom level.
+    class iterator {
+        node *v = nullptr;
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef const int& reference;
+
+        iterator() { }
+
+        explicit iterator(node *_v) : v(_v) { }
+
+        reference operator*() const {
+            return v->value;
+        }
+
+        pointer operator->() const {
+            return &v->value;
+        }
+
+        iterator& operator++() {
+            v = v->links()[0].next;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        bool operator==(const iterator& other) const {
+            return v == other.v;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return v != other.v;
+        }
+    };
+
+    skip_list()
+        : skip_list(size_class_pool(sizeof(node), sizeof(link), max_level + 1)) { }
+
+    skip_list(const skip_list&) = delete;
+
+    skip_list(skip_list&& other)
+        : rnd(other.rnd),
+          pool(std::move(other.pool)),
+          head(other.head),
+          levels(other.levels),
+          length(other.length) {
+        other.head = nullptr;
+    }
+
+    // The chunks are freed with the last pool sharing them.
+    ~skip_list() = default;
+
+    void insert(int before, int value) {
+        node *update[max_level];
+        int rank[max_level];
+        int height = random_height();
+        for (; levels < height; levels++)
+            head->links()[levels] = link{ nullptr, length + 1 };
+        find(before, update, rank);
+
+        node *v = new_node(value, height);
+        for (int i = 0; i < levels; i++) {
+            link& l = update[i]->links()[i];
+            if (i < height) {
+                v->links()[i] = link{ l.next, l.span - (before - rank[i]) };
+                l = link{ v, before - rank[i] + 1 };
+            } else {
+                l.span++;
+            }
+        }
+        length++;
+    }
+
+    void erase(int where) {
+        node *update[max_level];
+        int rank[max_level];
+        find(where, update, rank);
+
+        node *v = update[0]->links()[0].next;
+        for (int i = 0; i < levels; i++) {
+            link& l = update[i]->links()[i];
+            if (l.next == v)
+                l = link{ v->links()[i].next, l.span + v->links()[i].span - 1 };
+            else
+                l.span--;
+        }
+        pool.release(v, v->height);
+        length--;
+        while (levels > 1 && head->links()[levels - 1].next == nullptr)
+            levels--;
+    }
+
+    // Links the towers level by level in one pass.
+    void build(const int *first, const int *last) {
+        for (node *v = head->links()[0].next; v; ) {
+            node *next = v->links()[0].next;
+            pool.release(v, v->height);
+            v = next;
+        }
+        node *prev[max_level];
+        int prev_pos[max_level];
+        for (int i = 0; i < max_level; i++) {
+            prev[i] = head;
+            prev_pos[i] = 0;
+        }
+        levels = 1;
+        length = last - first;
+        for (int pos = 1; first != last; first++, pos++) {
+            int height = random_height();
+            node *v = new_node(*first, height);
+            for (int i = 0; i < height; i++) {
+                prev[i]->links()[i] = link{ v, pos - prev_pos[i] };
+                prev[i] = v;
+                prev_pos[i] = pos;
+            }
+            levels = std::max(levels, height);
+        }
+        for (int i = 0; i < max_level; i++)
+            prev[i]->links()[i] = link{ nullptr, length + 1 - prev_pos[i] };
+    }
+
+    int at(int index) {
+        node *v = head;
+        int pos = index + 1;
+        for (int i = levels - 1; i >= 0; i--) {
+            link *l = v->links() + i;
+            while (l->next && l->span <= pos) {
+                pos -= l->span;
+                v = l->next;
+                l = v->links() + i;
+            }
+        }
+        return v->value;
+    }
+
+    std::pair<skip_list, skip_list> split(int left) {
+        node *update[max_level];
+        int rank[max_level];
+        find(left, update, rank);
+
+        skip_list rt(pool.sibling());
+        rt.levels = levels;
+        rt.length = length - left;
+        for (int i = 0; i < levels; i++) {
+            link& l = update[i]->links()[i];
+            rt.head->links()[i] = link{ l.next, rank[i] + l.span - left };
+            l = link{ nullptr, left + 1 - rank[i] };
+        }
+        length = left;
+        while (levels > 1 && head->links()[levels - 1].next == nullptr)
+            levels--;
+        while (rt.levels > 1 && rt.head->links()[rt.levels - 1].next == nullptr)
+            rt.levels--;
+        return std::make_pair(std::move(*this), std::move(rt));
+    }
+
+    static skip_list merge(skip_list&& lt, skip_list&& rt) {
+        skip_list ret(std::move(lt));
+        ret.pool.adopt(rt.pool);
+        for (; ret.levels < rt.levels; ret.levels++)
+            ret.head->links()[ret.levels] = link{ nullptr, ret.length + 1 };
+
+        node *update[max_level];
+        int rank[max_level];
+        ret.find(ret.length, update, rank);
+        for (int i = 0; i < ret.levels; i++) {
+            link& l = update[i]->links()[i];
+            if (i < rt.levels)
+                l = link{ rt.head->links()[i].next, ret.length - rank[i] + rt.head->links()[i].span };
+            else
+                l.span += rt.length;
+        }
+        ret.length += rt.length;
+        return ret;
+    }
+
+    int size() const {
+        return length;
+    }
+
+    iterator begin() const {
+        return iterator(head->links()[0].next);
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    // The output must have room for size() values.
+    void copy_to(int *out) const {
+        for (node *v = head->links()[0].next; v; v = v->links()[0].next)
+            *out++ = v->value;
+    }
+
+    operator std::vector<int>() {
+        std::vector<int> ret(size());
+        copy_to(ret.data());
+        return ret;
+    }
+
+    static std::string name() {
+        return "skip_list<" + rnd_eng_name<random_eng>() + ">";
+    }
+};
+
+#endif
@@ -0,0 +1,321 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SOLUTIONS_SOA_TREAP_H_
+#define SOLUTIONS_SOA_TREAP_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <solutions/treap.h>
+
+/**
+ * The treap of olymp_treap with the nodes kept in parallel arrays and
+ * linked by 32-bit ids. The fields used on the way down (priority, size
+ * and children) don't share cache lines with the values. Id 0 is the
+ * null node of size 0, so the size lookups need no null checks.
+ */
+template<class random_eng>
+class soa_treap {
+    typedef std::uint32_t id;
+
+    random_eng rnd;
+    std::vector<int> y;
+    std::vector<int> sz;
+    std::vector<std::array<id, 2> > ch;
+    std::vector<int> x;
+    std::vector<id> free_ids;
+    id root = 0;
+
+    void reset() {
+        y.assign(1, 0);
+        sz.assign(1, 0);
+        ch.assign(1, {{ 0, 0 }});
+        x.assign(1, 0);
+        free_ids.clear();
+        root = 0;
+    }
+
+    id new_node(int value, int priority) {
+        if (!free_ids.empty()) {
+            id v = free_ids.back();
+            free_ids.pop_back();
+            y[v] = priority;
+            sz[v] = 1;
+            ch[v] = {{ 0, 0 }};
+            x[v] = value;
+            return v;
+        }
+        y.push_back(priority);
+        sz.push_back(1);
+        ch.push_back({{ 0, 0 }});
+        x.push_back(value);
+        return x.size() - 1;
+    }
+
+    void update(id v) {
+        sz[v] = 1 + sz[ch[v][0]] + sz[ch[v][1]];
+    }
+
+    void split(id v, int skip, id& left, id& right) {
+        if (!v) {
+            left = right = 0;
+            return;
+        }
+        if (sz[ch[v][0]] >= skip) {
+            split(ch[v][0], skip, left, ch[v][0]);
+            update(v);
+            right = v;
+        } else {
+            split(ch[v][1], skip - sz[ch[v][0]] - 1, ch[v][1], right);
+            update(v);
+            left = v;
+        }
+    }
+
+    id merge(id left, id right) {
+        if (!left)
+            return right;
+        if (!right)
+            return left;
+        if (y[left] < y[right]) {
+            ch[left][1] = merge(ch[left][1], right);
+            update(left);
+            return left;
+        } else {
+            ch[right][0] = merge(left, ch[right][0]);
+            update(right);
+            return right;
+        }
+    }
+
+    // Copies a subtree of another treap, keeping the priorities.
+    id copy_from(const soa_treap& other, id v) {
+        if (!v)
+            return 0;
+        id l = copy_from(other, other.ch[v][0]);
+        id r = copy_from(other, other.ch[v][1]);
+        id u = new_node(other.x[v], other.y[v]);
+        ch[u] = {{ l, r }};
+        sz[u] = other.sz[v];
+        return u;
+    }
+
+    void release(id v) {
+        if (!v)
+            return;
+        release(ch[v][0]);
+        release(ch[v][1]);
+        free_ids.push_back(v);
+    }
+
+    int calc_sizes(id v) {
+        if (!v)
+            return 0;
+        sz[v] = 1 + calc_sizes(ch[v][0]) + calc_sizes(ch[v][1]);
+        return sz[v];
+    }
+
+public:
+    // In-order iterator with the path to the current node on a stack.
+    class iterator {
+        const soa_treap *t = nullptr;
+        std::vector<id> stack;
+
+        void descend(id v) {
+            for (; v; v = t->ch[v][0])
+                stack.push_back(v);
+        }
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef const int& reference;
+
+        iterator() { }
+
+        iterator(const soa_treap *_t, id root) : t(_t) {
+            descend(root);
+        }
+
+        reference operator*() const {
+            return t->x[stack.back()];
+        }
+
+        pointer operator->() const {
+            return &t->x[stack.back()];
+        }
+
+        iterator& operator++() {
+            id v = stack.back();
+            stack.pop_back();
+            descend(t->ch[v][1]);
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        bool operator==(const iterator& other) const {
+            if (stack.empty() || other.stack.empty())
+                return stack.empty() == other.stack.empty();
+            return stack.back() == other.stack.back();
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    soa_treap()
+        : rnd(179) {
+        reset();
+    }
+    soa_treap(const soa_treap&) = delete;
+    soa_treap(soa_treap&&) = default;
+    ~soa_treap() = default;
+
+    void insert(int before, int value) {
+        id left, right;
+        split(root, before, left, right);
+        id mid = new_node(value, rnd());
+        right = merge(mid, right);
+        root = merge(left, right);
+    }
+
+    void erase(int which) {
+        id left, mid, right;
+        split(root, which, left, right);
+        split(right, 1, mid, right);
+        free_ids.push_back(mid);
+        root = merge(left, right);
+    }
+
+    // The right part is copied out, so this is linear in its size. Leaves this treap empty.
+    std::pair<soa_treap, soa_treap> split(int left) {
+        id l, r;
+        split(root, left, l, r);
+        soa_treap rt;
+        rt.root = rt.copy_from(*this, r);
+        release(r);
+        root = l;
+        soa_treap lt(std::move(*this));
+        reset();
+        return std::make_pair(std::move(lt), std::move(rt));
+    }
+
+    // Linear in the size of rt, whose nodes are copied into lt.
+    static soa_treap merge(soa_treap&& lt, soa_treap&& rt) {
+        soa_treap ret(std::move(lt));
+        lt.reset();
+        id r = ret.copy_from(rt, rt.root);
+        ret.root = ret.merge(ret.root, r);
+        return ret;
+    }
+
+    // Builds the Cartesian tree of the values on a stack in linear time.
+    void build(const int *first, const int *last) {
+        reset();
+        std::size_t n = last - first;
+        y.reserve(n + 1);
+        sz.reserve(n + 1);
+        ch.reserve(n + 1);
+        x.reserve(n + 1);
+        std::vector<id> stack;
+        for (; first != last; first++) {
+            id v = new_node(*first, rnd());
+            id prev = 0;
+            while (!stack.empty() && y[stack.back()] > y[v]) {
+                prev = stack.back();
+                stack.pop_back();
+            }
+            ch[v][0] = prev;
+            if (!stack.empty())
+                ch[stack.back()][1] = v;
+            stack.push_back(v);
+        }
+        root = stack.empty() ? 0 : stack[0];
+        calc_sizes(root);
+    }
+
+    int at(int i) {
+        id v = root;
+        while (true) {
+            if (i < sz[ch[v][0]]) {
+                v = ch[v][0];
+            } else if (i == sz[ch[v][0]]) {
+                return x[v];
+            } else {
+                i -= sz[ch[v][0]] + 1;
+                v = ch[v][1];
+            }
+        }
+    }
+
+    int size() const {
+        return sz[root];
+    }
+
+    iterator begin() const {
+        return iterator(this, root);
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    // The output must have room for size() values.
+    void copy_to(int *out) const {
+        std::vector<id> stack;
+        id v = root;
+        while (v || !stack.empty()) {
+            for (; v; v = ch[v][0])
+                stack.push_back(v);
+            v = stack.back();
+            stack.pop_back();
+            *out++ = x[v];
+            v = ch[v][1];
+        }
+    }
+
+    operator std::vector<int>() {
+        std::vector<int> ret(size());
+        copy_to(ret.data());
+        return ret;
+    }
+
+    static std::string name() {
+        return "soa_treap<" + rnd_eng_name<random_eng>() + ">";
+    }
+};
+
+#endif
@@ -25,9 +25,16 @@
 #include <queue>
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <iterator>
 
-class splay_tree {
-    struct node {
+#include <solutions/aggregate.h>
+#include <solutions/allocator.h>
+
+// The Aggregate adds range operations, see solutions/aggregate.h.
+template<class Alloc = heap_alloc, class Aggregate = no_aggregate>
+class basic_splay_tree {
+    struct node : Aggregate::data {
         node *L, *R, *par;
         int x, sz;
         node(int val) {
@@ -36,9 +43,12 @@ class splay_tree {
             L = nullptr;
             R = nullptr;
             par = nullptr;
+            Aggregate::pull(this);
         }
     };
 
+    typename Alloc::template pool<node> pool;
+
     int node_sz(node *v) {
         if (v)
             return v->sz;
@@ -49,6 +59,7 @@ class splay_tree {
     void update(node *v) {
         if (v) {
             v->sz = node_sz(v->L) + node_sz(v->R) + 1;
+            Aggregate::pull(v);
         }
     }
 
@@ -101,9 +112,38 @@ class splay_tree {
 
     node *root = nullptr;
 
+    // A splay tree may be a single chain, so the nodes are freed without recursion.
+    void del(node *root) {
+        if (!root)
+            return;
+        std::queue<node *> dq;
+        dq.push(root);
+        while (!dq.empty()) {
+            node *v = dq.front();
+            dq.pop();
+            if (v->L) dq.push(v->L);
+            if (v->R) dq.push(v->R);
+            pool.destroy(v);
+        }
+    }
+
+    node *build_balanced(const int *first, const int *last, node *par) {
+        if (first == last)
+            return nullptr;
+        const int *mid = first + (last - first) / 2;
+        node *v = pool.create(*mid);
+        v->par = par;
+        v->L = build_balanced(first, mid, v);
+        v->R = build_balanced(mid + 1, last, v);
+        update(v);
+        return v;
+    }
+
+    // Pushes the pending updates on the way, so the path can be splayed.
     node *find(int before) {
         node *v = root;
         while (true) {
+            Aggregate::push(v);
             if (before < node_sz(v->L))
                 v = v->L;
             else if (before == node_sz(v->L))
@@ -115,33 +155,121 @@ class splay_tree {
         }
     }
 
+    static const node *leftmost(const node *v) {
+        while (v->L)
+            v = v->L;
+        return v;
+    }
+
+    // Splits the tree t after the first k values, the root is left unset.
+    void cut(node *t, int k, node*& left, node*& right) {
+        if (k == 0) {
+            left = nullptr;
+            right = t;
+            return;
+        }
+        root = t;
+        splay(find(k - 1));
+        left = root;
+        right = left->R;
+        if (right)
+            right->par = nullptr;
+        left->R = nullptr;
+        update(left);
+    }
+
+    node *join(node *left, node *right) {
+        if (!left)
+            return right;
+        if (!right)
+            return left;
+        root = left;
+        splay(find(left->sz - 1));
+        root->R = right;
+        right->par = root;
+        update(root);
+        return root;
+    }
+
+    // Cuts out the subtree of the range, applies f to it and puts it back.
+    template<class F>
+    auto range(int l, int r, F f) -> decltype(f(nullptr)) {
+        static_assert(Aggregate::enabled, "the splay tree has no range aggregate");
+        node *left, *mid, *right;
+        cut(root, r, left, right);
+        cut(left, l, left, mid);
+        auto ret = f(mid);
+        root = join(join(left, mid), right);
+        return ret;
+    }
+
 public:
-    splay_tree() { }
-
-    splay_tree(const splay_tree&) = delete;
-
-    ~splay_tree() {
-        if (root) {
-            std::queue<node *> dq;
-            dq.push(root);
-            while (!dq.empty()) {
-                node *v = dq.front();
-                dq.pop();
-                if (v->L) dq.push(v->L);
-                if (v->R) dq.push(v->R);
-                delete v;
+    // In-order iterator following the parent links, it takes no extra memory.
+    class iterator {
+        const node *v = nullptr;
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int *pointer;
+        typedef const int& reference;
+
+        iterator() { }
+
+        explicit iterator(const node *_v) : v(_v) { }
+
+        reference operator*() const {
+            return v->x;
+        }
+
+        pointer operator->() const {
+            return &v->x;
+        }
+
+        iterator& operator++() {
+            if (v->R) {
+                v = leftmost(v->R);
+            } else {
+                while (v->par && v->par->R == v)
+                    v = v->par;
+                v = v->par;
             }
+            return *this;
         }
+
+        iterator operator++(int) {
+            iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        bool operator==(const iterator& other) const {
+            return v == other.v;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return v != other.v;
+        }
+    };
+
+    basic_splay_tree() { }
+
+    basic_splay_tree(const basic_splay_tree&) = delete;
+
+    ~basic_splay_tree() {
+        if (!Alloc::template pool<node>::bulk_release)
+            del(root);
     }
 
     void insert(int before, int value) {
-        node *a = new node(value);
+        node *a = pool.create(value);
         if (root == nullptr) {
             root = a;
             return;
         }
         node *v = root;
         while (true) {
+            Aggregate::push(v);
             if (node_sz(v->L) >= before) {
                 if (v->L == nullptr) {
                     v->L = a;
@@ -173,7 +301,7 @@ public:
                 root = v->R;
             if (v->par)
                 splay(v->par);
-            delete v;
+            pool.destroy(v);
             return;
         }
         if (!(v->R)) {
@@ -185,59 +313,74 @@ public:
                 root = v->L;
             if (v->par)
                 splay(v->par);
-            delete v;
+            pool.destroy(v);
             return;
         }
         node *u = v->R;
-        while (u->L) u = u->L;
+        Aggregate::push(u);
+        while (u->L) {
+            u = u->L;
+            Aggregate::push(u);
+        }
         std::swap(v->x, u->x);
         erase(where + 1);
     }
 
+    // Builds a perfectly balanced tree.
+    void build(const int *first, const int *last) {
+        del(root);
+        root = build_balanced(first, last, nullptr);
+    }
+
     int at(int index) {
         node *v = find(index);
         splay(v);
         return v->x;
     }
 
+    int size() const {
+        return root ? root->sz : 0;
+    }
+
+    iterator begin() const {
+        push_all<Aggregate>(root);
+        return iterator(root ? leftmost(root) : nullptr);
+    }
+
+    iterator end() const {
+        return iterator();
+    }
+
+    // The output must have room for size() values.
+    void copy_to(int *out) const {
+        for (iterator it = begin(); it != end(); ++it)
+            *out++ = *it;
+    }
+
     operator std::vector<int>() {
-        std::vector<int> ret;
-        node *v = root;
-        int last = 0;
-        while (v) {
-            if (last == 0) {
-                if (v->L) {
-                    v = v->L;
-                } else if (v->R) {
-                    ret.push_back(v->x);
-                    v = v->R;
-                } else {
-                    ret.push_back(v->x);
-                    last = (v->par->L == v ? 1 : 2);
-                    v = v->par;
-                }
-            } else if (last == 1) {
-                ret.push_back(v->x);
-                if (v->R) {
-                    last = 0;
-                    v = v->R;
-                } else if (v->par) {
-                    last = (v->par->L == v ? 1 : 2);
-                    v = v->par;
-                } else {
-                    v = v->par;
-                }
-            } else {
-                if (v->par) {
-                    last = (v->par->L == v ? 1 : 2);
-                    v = v->par;
-                } else {
-                    v = v->par;
-                }
-            }
-        }
+        std::vector<int> ret(size());
+        copy_to(ret.data());
         return ret;
     }
 
-    static std::string name() { return "splay"; }
-};
\ No newline at end of file
+    // The range operations take the half-open range [l, r), which must not be empty.
+    long long sum(int l, int r) {
+        return range(l, r, [](node *v) { return v->sum; });
+    }
+
+    int min(int l, int r) {
+        return range(l, r, [](node *v) { return v->min; });
+    }
+
+    void add(int l, int r, int delta) {
+        range(l, r, [delta](node *v) { Aggregate::apply_add(v, delta); return 0; });
+    }
+
+    void reverse(int l, int r) {
+        range(l, r, [](node *v) { Aggregate::apply_reverse(v); return 0; });
+    }
+
+    static std::string name() { return aggregate_name<Alloc, Aggregate>("splay"); }
+};
+
+typedef basic_splay_tree<> splay_tree;
\ No newline at end of file
@@ -21,16 +21,25 @@
  * SOFTWARE.
  */
 
+#ifndef SOLUTIONS_TREAP_H_
+#define SOLUTIONS_TREAP_H_
+
 #include <cstdlib>
 #include <string>
 #include <random>
+#include <vector>
+
+#include <solutions/aggregate.h>
+#include <solutions/allocator.h>
+#include <solutions/tree_iterator.h>
 
+// The C library generator. rand_r keeps the state in the instance, so
+// concurrent cells don't race on the global state of rand.
 struct c_rnd_eng {
-    c_rnd_eng(int seed) {
-        std::srand(seed);
-    }
+    unsigned seed_;
+    c_rnd_eng(int seed) : seed_(seed) { }
     int operator()() {
-        return std::rand();
+        return rand_r(&seed_);
     }
 };
 
@@ -49,11 +58,16 @@ std::string rnd_eng_name<std::mt19937>() {
     return "mt19937";
 }
 
-template<class random_eng>
+/**
+ * The Aggregate adds range operations, see solutions/aggregate.h. Only
+ * olymp_treap supports them, opt_treap and nr_treap descend without
+ * pushing the pending updates.
+ */
+template<class random_eng, class Alloc = heap_alloc, class Aggregate = no_aggregate>
 class olymp_treap {
 protected:
     random_eng rnd;
-    struct node {
+    struct node : Aggregate::data {
         int x, y;
         int sz;
         node *L, *R;
@@ -62,8 +76,10 @@ protected:
             y = eng();
             sz = 1;
             L = R = nullptr;
+            Aggregate::pull(this);
         }
     };
+    typename Alloc::template pool<node> pool;
     static int node_sz(node *v) {
         if (!v) return 0;
         return v->sz;
@@ -71,6 +87,7 @@ protected:
     static void update(node *v) {
         if (v) {
             v->sz = 1 + node_sz(v->L) + node_sz(v->R);
+            Aggregate::pull(v);
         }
     }
     static void split(node *v, int skip, node*& left, node*& right) {
@@ -78,6 +95,7 @@ protected:
             left = right = nullptr;
             return;
         }
+        Aggregate::push(v);
         if (node_sz(v->L) >= skip) {
             split(v->L, skip, left, v->L);
             update(v);
@@ -94,16 +112,19 @@ protected:
         if (!right)
             return left;
         if (left->y < right->y) {
+            Aggregate::push(left);
             left->R = merge(left->R, right);
             update(left);
             return left;
         } else {
+            Aggregate::push(right);
             right->L = merge(left, right->L);
             update(right);
             return right;
         }
     }
     node *get(node *v, int at) {
+        Aggregate::push(v);
         if (at < node_sz(v->L)) {
             return get(v->L, at);
         } else if (at == node_sz(v->L)) {
@@ -112,23 +133,37 @@ protected:
             return get(v->R, at - node_sz(v->L) - 1);
         }
     }
+    static int calc_sizes(node *v) {
+        if (!v) return 0;
+        calc_sizes(v->L);
+        calc_sizes(v->R);
+        update(v);
+        return v->sz;
+    }
     void del(node *mem) {
         if (!mem) return;
         del(mem->L);
         del(mem->R);
-        delete mem;
+        pool.destroy(mem);
+    }
+    // Cuts out the subtree of the range, applies f to it and puts it back.
+    template<class F>
+    auto range(int l, int r, F f) -> decltype(f(nullptr)) {
+        static_assert(Aggregate::enabled, "the treap has no range aggregate");
+        node *left, *mid, *right;
+        split(root, l, left, right);
+        split(right, r - l, mid, right);
+        auto ret = f(mid);
+        root = merge(merge(left, mid), right);
+        return ret;
     }
     node *root = nullptr;
     olymp_treap(node *_root) : olymp_treap() {
         root = _root;
     }
-    void to_vector(node *v, std::vector<int>& w) {
-        if (!v) return;
-        to_vector(v->L, w);
-        w.push_back(v->x);
-        to_vector(v->R, w);
-    }
 public:
+    typedef tree_iterator<node> iterator;
+
     olymp_treap()
         : rnd(179)
     {};
@@ -136,7 +171,7 @@ public:
     virtual void insert(int before, int value) {
         node *left, *mid, *right;
         split(root, before, left, right);
-        mid = new node(value, rnd);
+        mid = pool.create(value, rnd);
         right = merge(mid, right);
         root = merge(left, right);
     }
@@ -144,115 +179,165 @@ public:
         node *left, *mid, *right;
         split(root, which, left, right);
         split(right, 1, mid, right);
-        delete mid;
+        pool.destroy(mid);
         root = merge(left, right);
     }
-    std::pair<olymp_treap<random_eng>, olymp_treap<random_eng> > split(int left) {
+    std::pair<olymp_treap, olymp_treap> split(int left) {
         node *lt, *rt;
         split(root, left, lt, rt);
         return std::make_pair(olymp_treap(lt), olymp_treap(rt));
     };
-    static olymp_treap<random_eng>&& merge(const olymp_treap<random_eng>&& lt, const olymp_treap<random_eng>&& rt) {
+    static olymp_treap&& merge(const olymp_treap&& lt, const olymp_treap&& rt) {
         node *root = merge(lt.root, rt.root);
         return olymp_treap(root);
     }
     static std::string name() {
-        return "olymp_treap<" + rnd_eng_name<random_eng>() + ">";
+        return "olymp_treap<" + rnd_eng_name<random_eng>() + alloc_suffix<Alloc>() + aggregate_suffix<Aggregate>() + ">";
     }
     virtual ~olymp_treap() {
+        if (!Alloc::template pool<node>::bulk_release)
+            del(root);
+    }
+    // Builds the Cartesian tree of the values on a stack in linear time.
+    void build(const int *first, const int *last) {
         del(root);
+        std::vector<node *> stack;
+        for (; first != last; first++) {
+            node *v = pool.create(*first, rnd);
+            node *prev = nullptr;
+            while (!stack.empty() && stack.back()->y > v->y) {
+                prev = stack.back();
+                stack.pop_back();
+            }
+            v->L = prev;
+            if (!stack.empty())
+                stack.back()->R = v;
+            stack.push_back(v);
+        }
+        root = stack.empty() ? nullptr : stack[0];
+        calc_sizes(root);
     }
     int at(int i) {
         return get(root, i)->x;
     }
+    int size() const {
+        return node_sz(root);
+    }
+    iterator begin() const {
+        push_all<Aggregate>(root);
+        return iterator(root);
+    }
+    iterator end() const {
+        return iterator();
+    }
+    // The output must have room for size() values.
+    void copy_to(int *out) const {
+        push_all<Aggregate>(root);
+        copy_tree(root, out);
+    }
+    // The range operations take the half-open range [l, r), which must not be empty.
+    long long sum(int l, int r) {
+        return range(l, r, [](node *v) { return v->sum; });
+    }
+    int min(int l, int r) {
+        return range(l, r, [](node *v) { return v->min; });
+    }
+    void add(int l, int r, int delta) {
+        range(l, r, [delta](node *v) { Aggregate::apply_add(v, delta); return 0; });
+    }
+    void reverse(int l, int r) {
+        range(l, r, [](node *v) { Aggregate::apply_reverse(v); return 0; });
+    }
     operator std::vector<int>() {
-        std::vector<int> ret;
-        to_vector(root, ret);
+        std::vector<int> ret(size());
+        copy_to(ret.data());
         return ret;
     }
 };
 
-template<class random_eng>
-class opt_treap : public olymp_treap<random_eng> {
+template<class random_eng, class Alloc = heap_alloc>
+class opt_treap : public olymp_treap<random_eng, Alloc> {
 protected:
-    typedef typename olymp_treap<random_eng>::node node;
+    typedef typename olymp_treap<random_eng, Alloc>::node node;
     virtual node *add(node *v, int after, node *to_add) {
         if (v == nullptr)
             return to_add;
         else if (to_add->y < v->y) {
-            olymp_treap<random_eng>::split(v, after, to_add->L, to_add->R);
-            olymp_treap<random_eng>::update(to_add);
+            olymp_treap<random_eng, Alloc>::split(v, after, to_add->L, to_add->R);
+            olymp_treap<random_eng, Alloc>::update(to_add);
             return to_add;
-        } else if (olymp_treap<random_eng>::node_sz(v->L) >= after) {
+        } else if (olymp_treap<random_eng, Alloc>::node_sz(v->L) >= after) {
             v->L = add(v->L, after, to_add);
-            olymp_treap<random_eng>::update(v);
+            olymp_treap<random_eng, Alloc>::update(v);
         } else {
-            v->R = add(v->R, after - olymp_treap<random_eng>::node_sz(v->L) - 1, to_add);
-            olymp_treap<random_eng>::update(v);
+            v->R = add(v->R, after - olymp_treap<random_eng, Alloc>::node_sz(v->L) - 1, to_add);
+            olymp_treap<random_eng, Alloc>::update(v);
         }
         return v;
     }
     virtual node *remove(node *v, int which) {
-        if (which == olymp_treap<random_eng>::node_sz(v->L))
-            return olymp_treap<random_eng>::merge(v->L, v->R);
-        else if (which < olymp_treap<random_eng>::node_sz(v->L)) {
+        if (which == olymp_treap<random_eng, Alloc>::node_sz(v->L)) {
+            node *ret = olymp_treap<random_eng, Alloc>::merge(v->L, v->R);
+            olymp_treap<random_eng, Alloc>::pool.destroy(v);
+            return ret;
+        } else if (which < olymp_treap<random_eng, Alloc>::node_sz(v->L)) {
             v->L = remove(v->L, which);
-            olymp_treap<random_eng>::update(v);
+            olymp_treap<random_eng, Alloc>::update(v);
         } else {
-            v->R = remove(v->R, which - olymp_treap<random_eng>::node_sz(v->L) - 1);
-            olymp_treap<random_eng>::update(v);
+            v->R = remove(v->R, which - olymp_treap<random_eng, Alloc>::node_sz(v->L) - 1);
+            olymp_treap<random_eng, Alloc>::update(v);
         }
         return v;
     }
-    opt_treap(node *_root) : olymp_treap<random_eng>(_root) { }
+    opt_treap(node *_root) : olymp_treap<random_eng, Alloc>(_root) { }
 public:
-    opt_treap() : olymp_treap<random_eng>() { }
+    opt_treap() : olymp_treap<random_eng, Alloc>() { }
     virtual void insert(int before, int value) {
-        olymp_treap<random_eng>::root = add(olymp_treap<random_eng>::root, before, new node(value, olymp_treap<random_eng>::rnd));
+        olymp_treap<random_eng, Alloc>::root = add(olymp_treap<random_eng, Alloc>::root, before, olymp_treap<random_eng, Alloc>::pool.create(value, olymp_treap<random_eng, Alloc>::rnd));
     }
     virtual void erase(int which) {
-        olymp_treap<random_eng>::root = remove(olymp_treap<random_eng>::root, which);
+        olymp_treap<random_eng, Alloc>::root = remove(olymp_treap<random_eng, Alloc>::root, which);
     }
     static std::string name() {
-        return "opt_treap<" + rnd_eng_name<random_eng>() + ">";
+        return "opt_treap<" + rnd_eng_name<random_eng>() + alloc_suffix<Alloc>() + ">";
     }
 };
 
-template<class random_eng>
-class nr_treap : public opt_treap<random_eng> {
+template<class random_eng, class Alloc = heap_alloc>
+class nr_treap : public opt_treap<random_eng, Alloc> {
 protected:
-    typedef typename olymp_treap<random_eng>::node node;
+    typedef typename olymp_treap<random_eng, Alloc>::node node;
     virtual node *add(node *v, int after, node *to_add) {
         if (v == nullptr)
             return to_add;
         if (to_add->y < v->y) {
-            olymp_treap<random_eng>::split(v, after, to_add->L, to_add->R);
-            olymp_treap<random_eng>::update(to_add);
+            olymp_treap<random_eng, Alloc>::split(v, after, to_add->L, to_add->R);
+            olymp_treap<random_eng, Alloc>::update(to_add);
             return to_add;
         }
         node *ret = v;
         while (true) {
             v->sz++;
-            if (olymp_treap<random_eng>::node_sz(v->L) >= after) {
+            if (olymp_treap<random_eng, Alloc>::node_sz(v->L) >= after) {
                 if (v->L == nullptr) {
                     v->L = to_add;
                     break;
                 } else if (to_add->y < v->L->y) {
-                    olymp_treap<random_eng>::split(v->L, after, to_add->L, to_add->R);
-                    olymp_treap<random_eng>::update(to_add);
+                    olymp_treap<random_eng, Alloc>::split(v->L, after, to_add->L, to_add->R);
+                    olymp_treap<random_eng, Alloc>::update(to_add);
                     v->L = to_add;
                     break;
                 } else {
                     v = v->L;
                 }
             } else {
-                after -= olymp_treap<random_eng>::node_sz(v->L) + 1;
+                after -= olymp_treap<random_eng, Alloc>::node_sz(v->L) + 1;
                 if (v->R == nullptr) {
                     v->R = to_add;
                     break;
                 } else if (to_add->y < v->R->y) {
-                    olymp_treap<random_eng>::split(v->R, after, to_add->L, to_add->R);
-                    olymp_treap<random_eng>::update(to_add);
+                    olymp_treap<random_eng, Alloc>::split(v->R, after, to_add->L, to_add->R);
+                    olymp_treap<random_eng, Alloc>::update(to_add);
                     v->R = to_add;
                     break;
                 } else {
@@ -263,23 +348,29 @@ protected:
         return ret;
     }
     virtual node *remove(node *v, int which) {
-        if (which == olymp_treap<random_eng>::node_sz(v->L)) {
-            return olymp_treap<random_eng>::merge(v->L, v->R);
+        if (which == olymp_treap<random_eng, Alloc>::node_sz(v->L)) {
+            node *ret = olymp_treap<random_eng, Alloc>::merge(v->L, v->R);
+            olymp_treap<random_eng, Alloc>::pool.destroy(v);
+            return ret;
         }
         node *ret = v;
         while (true) {
             v->sz--;
-            if (which < olymp_treap<random_eng>::node_sz(v->L)) {
-                if (which == olymp_treap<random_eng>::node_sz(v->L->L)) {
-                    v->L = olymp_treap<random_eng>::merge(v->L->L, v->L->R);
+            if (which < olymp_treap<random_eng, Alloc>::node_sz(v->L)) {
+                if (which == olymp_treap<random_eng, Alloc>::node_sz(v->L->L)) {
+                    node *dead = v->L;
+                    v->L = olymp_treap<random_eng, Alloc>::merge(dead->L, dead->R);
+                    olymp_treap<random_eng, Alloc>::pool.destroy(dead);
                     break;
                 } else {
                     v = v->L;
                 }
             } else {
-                which -= olymp_treap<random_eng>::node_sz(v->L) + 1;
-                if (which == olymp_treap<random_eng>::node_sz(v->R->L)) {
-                    v->R = olymp_treap<random_eng>::merge(v->R->L, v->R->R);
+                which -= olymp_treap<random_eng, Alloc>::node_sz(v->L) + 1;
+                if (which == olymp_treap<random_eng, Alloc>::node_sz(v->R->L)) {
+                    node *dead = v->R;
+                    v->R = olymp_treap<random_eng, Alloc>::merge(dead->L, dead->R);
+                    olymp_treap<random_eng, Alloc>::pool.destroy(dead);
                     break;
                 } else {
                     v = v->R;
@@ -290,6 +381,8 @@ protected:
     }
 public:
     static std::string name() {
-        return "nr_treap<" + rnd_eng_name<random_eng>() + ">";
+        return "nr_treap<" + rnd_eng_name<random_eng>() + alloc_suffix<Alloc>() + ">";
     }
-};
\ No newline at end of file
+};
+
+#endif
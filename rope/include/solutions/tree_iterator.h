@@ -0,0 +1,105 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SOLUTIONS_TREE_ITERATOR_H_
+#define SOLUTIONS_TREE_ITERATOR_H_
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+/**
+ * In-order iterator over a binary tree of nodes with L, R and x fields.
+ * The path to the current node is kept on an explicit stack, so a
+ * degenerate tree costs heap memory and not the call stack.
+ */
+template<class Node>
+class tree_iterator {
+    std::vector<const Node *> stack;
+
+    void descend(const Node *v) {
+        for (; v; v = v->L)
+            stack.push_back(v);
+    }
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef int value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const int *pointer;
+    typedef const int& reference;
+
+    tree_iterator() { }
+
+    explicit tree_iterator(const Node *root) {
+        descend(root);
+    }
+
+    reference operator*() const {
+        return stack.back()->x;
+    }
+
+    pointer operator->() const {
+        return &stack.back()->x;
+    }
+
+    tree_iterator& operator++() {
+        const Node *v = stack.back();
+        stack.pop_back();
+        descend(v->R);
+        return *this;
+    }
+
+    tree_iterator operator++(int) {
+        tree_iterator ret = *this;
+        ++*this;
+        return ret;
+    }
+
+    bool operator==(const tree_iterator& other) const {
+        if (stack.empty() || other.stack.empty())
+            return stack.empty() == other.stack.empty();
+        return stack.back() == other.stack.back();
+    }
+
+    bool operator!=(const tree_iterator& other) const {
+        return !(*this == other);
+    }
+};
+
+// Writes the values of the tree in order, returns the end of the output.
+template<class Node>
+int *copy_tree(const Node *root, int *out) {
+    std::vector<const Node *> stack;
+    const Node *v = root;
+    while (v || !stack.empty()) {
+        for (; v; v = v->L)
+            stack.push_back(v);
+        v = stack.back();
+        stack.pop_back();
+        *out++ = v->x;
+        v = v->R;
+    }
+    return out;
+}
+
+#endif
@@ -24,12 +24,16 @@
 #ifndef SOLUTIONS_VERIFY_H_
 #define SOLUTIONS_VERIFY_H_
 
+#include <algorithm>
+#include <numeric>
 #include <string>
 #include <vector>
 
 class verify {
     std::vector<int> w;
 public:
+    typedef std::vector<int>::const_iterator iterator;
+
     verify() { }
 
     verify(const verify&) = delete;
@@ -44,10 +48,47 @@ public:
         w.erase(w.begin() + where);
     }
 
+    void build(const int *first, const int *last) {
+        w.assign(first, last);
+    }
+
     int at(int index) {
         return w[index];
     }
 
+    int size() const {
+        return w.size();
+    }
+
+    iterator begin() const {
+        return w.begin();
+    }
+
+    iterator end() const {
+        return w.end();
+    }
+
+    void copy_to(int *out) const {
+        std::copy(w.begin(), w.end(), out);
+    }
+
+    long long sum(int l, int r) {
+        return std::accumulate(w.begin() + l, w.begin() + r, 0LL);
+    }
+
+    int min(int l, int r) {
+        return *std::min_element(w.begin() + l, w.begin() + r);
+    }
+
+    void add(int l, int r, int delta) {
+        for (int i = l; i < r; i++)
+            w[i] += delta;
+    }
+
+    void reverse(int l, int r) {
+        std::reverse(w.begin() + l, w.begin() + r);
+    }
+
     operator std::vector<int>() {
         return w;
     }
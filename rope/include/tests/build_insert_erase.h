@@ -54,8 +54,8 @@ public:
         return "build_insert_erase";
     }
 
-    std::vector<std::string> tested_params() const {
-        return { "build", "insert", "erase" };
+    static constexpr speedtest::ParamList<3> params() {
+        return {{ "build", "insert", "erase" }};
     }
 
     template<class Solution>
@@ -68,6 +68,7 @@ public:
             int x = dist_(rnd_);
             MULTIPARAMTEST_INVOKE("build", s.insert(i, x);)
         }
+        speedtest::memory_checkpoint("build", n_);
         
         int cnt = n_;
         for (int i = 0; i < m_; i++) {
@@ -87,6 +88,7 @@ public:
                 cnt--;
             }
         }
+        speedtest::memory_checkpoint("end", cnt);
 
 #ifdef VERIFY
         if (Solution::name() == "verify") {
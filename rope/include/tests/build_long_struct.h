@@ -21,6 +21,8 @@
  * SOFTWARE.
  */
 
+#include <speedtest/runtime.h>
+
 #include <random>
 #include <limits>
 #include <solutions/verify.h>
@@ -57,6 +59,7 @@ public:
             int x = dist_(rnd_);
             s.insert(i, x);
         }
+        speedtest::memory_checkpoint("build", n_);
 
 #ifdef VERIFY
         if (Solution::name() == "verify") {
@@ -21,6 +21,8 @@
  * SOFTWARE.
  */
 
+#include <speedtest/runtime.h>
+
 #include <random>
 #include <limits>
 #include <algorithm>
@@ -60,6 +62,7 @@ public:
             int x = dist_(rnd_);
             s.insert(at, x);
         }
+        speedtest::memory_checkpoint("build", n_);
 
 #ifdef VERIFY
         if (Solution::name() == "verify") {
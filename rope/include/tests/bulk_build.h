@@ -0,0 +1,102 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/runtime.h>
+
+#include <random>
+#include <limits>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <solutions/verify.h>
+
+/**
+ * Builds a rope from an array twice: by appending the values one by one
+ * and by a single call to build(). Then the rope built by appends is
+ * built again, so build() has to free the old contents first. All three
+ * are timed as parameters.
+ */
+class bulk_build {
+    std::shared_ptr<const std::vector<int>> values_;
+#ifdef VERIFY
+    std::vector<int> w;
+#endif
+public:
+    bulk_build(int seed, int n) {
+        std::mt19937 rnd(seed);
+        std::uniform_int_distribution<int> dist(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+        auto values = std::make_shared<std::vector<int>>(n);
+        for (int& x : *values)
+            x = dist(rnd);
+        values_ = values;
+#ifdef VERIFY
+        std::cerr << "Running verification solution on test " << name() << std::endl;
+        test<verify>();
+#endif
+    }
+
+    std::string name() const {
+        return "bulk_build";
+    }
+
+    static constexpr speedtest::ParamList<3> params() {
+        return {{ "incremental", "bulk", "rebuild" }};
+    }
+
+    template<class Solution>
+    bool test() {
+        const std::vector<int>& values = *values_;
+        int n = values.size();
+
+        Solution incremental;
+        MULTIPARAMTEST_INVOKE("incremental", for (int i = 0; i < n; i++) incremental.insert(i, values[i]);)
+
+        Solution bulk;
+        MULTIPARAMTEST_INVOKE("bulk", bulk.build(values.data(), values.data() + n);)
+        speedtest::memory_checkpoint("build", 2LL * n);
+
+        // Replaces the contents of the rope filled by appends.
+        MULTIPARAMTEST_INVOKE("rebuild", incremental.build(values.data(), values.data() + n);)
+
+#ifdef VERIFY
+        if (Solution::name() == "verify") {
+            w = (std::vector<int>)bulk;
+        } else {
+            for (int i = 0; i < n; i++) {
+                if (w[i] != bulk.at(i) || w[i] != incremental.at(i))
+                    return false;
+            }
+            if (w != (std::vector<int>)bulk || w != (std::vector<int>)incremental)
+                return false;
+            // The built structure must stay usable.
+            bulk.insert(n / 2, 0);
+            if (bulk.at(n / 2) != 0)
+                return false;
+            bulk.erase(n / 2);
+        }
+#endif
+
+        return true;
+    }
+};
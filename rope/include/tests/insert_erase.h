@@ -49,8 +49,8 @@ public:
         return "insert_erase";
     }
 
-    std::vector<std::string> tested_params() const {
-        return { "insert", "erase" };
+    static constexpr speedtest::ParamList<2> params() {
+        return {{ "insert", "erase" }};
     }
 
     template<class Solution>
@@ -77,6 +77,7 @@ public:
                 cnt--;
             }
         }
+        speedtest::memory_checkpoint("end", cnt);
 
 #ifdef VERIFY
         if (Solution::name() == "verify") {
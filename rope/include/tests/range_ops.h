@@ -0,0 +1,161 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/runtime.h>
+
+#include <algorithm>
+#include <random>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <solutions/verify.h>
+
+/**
+ * Random range queries and updates mixed with inserts and erases on a
+ * rope of about n elements, built with build() outside the measured
+ * invocations. The operations are generated in advance; the ranges are
+ * half-open and never empty.
+ */
+class range_ops {
+    enum class opcode { insert, erase, sum, min, add, reverse };
+
+    struct op {
+        opcode code;
+        int l, r;
+        int value;
+    };
+
+    std::shared_ptr<const std::vector<int>> values_;
+    std::shared_ptr<const std::vector<op>> ops_;
+    long long checksum_ = 0;
+#ifdef VERIFY
+    std::vector<int> w;
+    std::vector<long long> answers;
+#endif
+public:
+    range_ops(int seed, int n, int m) {
+        std::mt19937 rnd(seed);
+        std::uniform_int_distribution<int> value(-1000000, 1000000);
+        std::uniform_int_distribution<int> delta(-100, 100);
+        auto values = std::make_shared<std::vector<int>>(n);
+        for (int& x : *values)
+            x = value(rnd);
+        auto ops = std::make_shared<std::vector<op>>(m);
+        int size = n;
+        for (op& o : *ops) {
+            o.code = static_cast<opcode>(rnd() % 6);
+            if (size < 2)
+                o.code = opcode::insert;
+            if (o.code == opcode::insert) {
+                o.l = rnd() % (size + 1);
+                o.value = value(rnd);
+                size++;
+            } else if (o.code == opcode::erase) {
+                o.l = rnd() % size;
+                size--;
+            } else {
+                o.l = rnd() % size;
+                o.r = rnd() % size;
+                if (o.l > o.r)
+                    std::swap(o.l, o.r);
+                o.r++;
+                o.value = delta(rnd);
+            }
+        }
+        values_ = values;
+        ops_ = ops;
+#ifdef VERIFY
+        std::cerr << "Running verification solution on test " << name() << std::endl;
+        test<verify>();
+#endif
+    }
+
+    std::string name() const {
+        return "range_ops";
+    }
+
+    static constexpr speedtest::ParamList<6> params() {
+        return {{ "insert", "erase", "sum", "min", "add", "reverse" }};
+    }
+
+    template<class Solution>
+    bool test() {
+        const std::vector<int>& values = *values_;
+        Solution s;
+        s.build(values.data(), values.data() + values.size());
+        speedtest::memory_checkpoint("build", values.size());
+
+        long long checksum = 0;
+#ifdef VERIFY
+        std::vector<long long> got;
+#endif
+        for (const op& o : *ops_) {
+            long long answer = 0;
+            switch (o.code) {
+            case opcode::insert:
+                MULTIPARAMTEST_INVOKE("insert", s.insert(o.l, o.value);)
+                break;
+            case opcode::erase:
+                MULTIPARAMTEST_INVOKE("erase", s.erase(o.l);)
+                break;
+            case opcode::sum:
+                MULTIPARAMTEST_INVOKE("sum", answer = s.sum(o.l, o.r);)
+                break;
+            case opcode::min:
+                MULTIPARAMTEST_INVOKE("min", answer = s.min(o.l, o.r);)
+                break;
+            case opcode::add:
+                MULTIPARAMTEST_INVOKE("add", s.add(o.l, o.r, o.value);)
+                break;
+            case opcode::reverse:
+                MULTIPARAMTEST_INVOKE("reverse", s.reverse(o.l, o.r);)
+                break;
+            }
+            checksum += answer;
+#ifdef VERIFY
+            got.push_back(answer);
+#endif
+        }
+        checksum_ = checksum;
+
+#ifdef VERIFY
+        if (Solution::name() == "verify") {
+            w = (std::vector<int>)s;
+            answers = got;
+        } else {
+            if (answers != got)
+                return false;
+            for (int i = 0; i < (int)w.size(); i++) {
+                if (w[i] != s.at(i))
+                    return false;
+            }
+            if (w != (std::vector<int>)s)
+                return false;
+        }
+#endif
+
+        return true;
+    }
+};
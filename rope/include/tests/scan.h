@@ -0,0 +1,103 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/runtime.h>
+
+#include <random>
+#include <limits>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <solutions/verify.h>
+
+/**
+ * Reads the whole sequence of a built rope several times: through the
+ * iterators, with copy_to into a preallocated buffer and through the
+ * conversion to std::vector<int>. The rope is filled with build()
+ * outside the measured invocations.
+ */
+class scan {
+    std::shared_ptr<const std::vector<int>> values_;
+    int passes_;
+    long long checksum_ = 0;
+#ifdef VERIFY
+    std::vector<int> w;
+#endif
+public:
+    scan(int seed, int n, int passes)
+        : passes_(passes) {
+        std::mt19937 rnd(seed);
+        std::uniform_int_distribution<int> dist(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+        auto values = std::make_shared<std::vector<int>>(n);
+        for (int& x : *values)
+            x = dist(rnd);
+        values_ = values;
+#ifdef VERIFY
+        std::cerr << "Running verification solution on test " << name() << std::endl;
+        test<verify>();
+#endif
+    }
+
+    std::string name() const {
+        return "scan";
+    }
+
+    static constexpr speedtest::ParamList<3> params() {
+        return {{ "iterate", "copy_to", "to_vector" }};
+    }
+
+    template<class Solution>
+    bool test() {
+        const std::vector<int>& values = *values_;
+        Solution s;
+        s.build(values.data(), values.data() + values.size());
+        speedtest::memory_checkpoint("build", values.size());
+
+        long long checksum = 0;
+        std::vector<int> out(values.size());
+        std::vector<int> converted;
+        for (int pass = 0; pass < passes_; pass++) {
+            MULTIPARAMTEST_INVOKE("iterate", for (int x : s) checksum += x;)
+            MULTIPARAMTEST_INVOKE("copy_to", s.copy_to(out.data());)
+            checksum += out[0];
+            MULTIPARAMTEST_INVOKE("to_vector", converted = (std::vector<int>)s;)
+            checksum += converted.size();
+        }
+        checksum_ = checksum;
+
+#ifdef VERIFY
+        std::vector<int> it(s.begin(), s.end());
+        std::vector<int> copied(s.size());
+        s.copy_to(copied.data());
+        if (Solution::name() == "verify") {
+            w = converted;
+        } else if (w != converted || w != it || w != copied) {
+            return false;
+        }
+#endif
+
+        return true;
+    }
+};
@@ -0,0 +1,112 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/runtime.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <solutions/verify.h>
+#include <trace/generate.h>
+
+/**
+ * Random inserts, erases and accesses on a structure of about n
+ * elements. The structure is built by appends outside the measured
+ * invocations, so a sweep over n shows the cost of an operation at
+ * each size. The operations are generated in advance.
+ */
+class steady_state {
+    int n_;
+    std::shared_ptr<const std::vector<trace_op>> ops_;
+    long long final_size_;
+    int checksum_ = 0;
+#ifdef VERIFY
+    std::vector<int> w;
+#endif
+public:
+    steady_state(int seed, int n, int m)
+        : n_(n),
+          ops_(std::make_shared<const std::vector<trace_op>>(trace_gen::steady_state(seed, n, m))) {
+        final_size_ = n_;
+        for (const trace_op& op : *ops_) {
+            if (op.opcode() == trace_opcode::insert)
+                final_size_++;
+            else if (op.opcode() == trace_opcode::erase)
+                final_size_--;
+        }
+#ifdef VERIFY
+        std::cerr << "Running verification solution on test " << name() << std::endl;
+        test<verify>();
+#endif
+    }
+
+    std::string name() const {
+        return "steady_state";
+    }
+
+    static constexpr speedtest::ParamList<3> params() {
+        return {{ "insert", "erase", "at" }};
+    }
+
+    template<class Solution>
+    bool test() {
+        Solution s;
+        int checksum = 0;
+
+        for (int i = 0; i < n_; i++)
+            s.insert(i, i);
+        speedtest::memory_checkpoint("build", n_);
+
+        for (const trace_op& op : *ops_) {
+            switch (op.opcode()) {
+            case trace_opcode::insert:
+                MULTIPARAMTEST_INVOKE("insert", s.insert(op.position(), op.value);)
+                break;
+            case trace_opcode::erase:
+                MULTIPARAMTEST_INVOKE("erase", s.erase(op.position());)
+                break;
+            default:
+                MULTIPARAMTEST_INVOKE("at", checksum ^= s.at(op.position());)
+                break;
+            }
+        }
+        checksum_ = checksum;
+
+#ifdef VERIFY
+        if (Solution::name() == "verify") {
+            w = (std::vector<int>)s;
+        } else {
+            for (int i = 0; i < final_size_; i++) {
+                if (w[i] != s.at(i))
+                    return false;
+            }
+            if (w != (std::vector<int>)s)
+                return false;
+        }
+#endif
+
+        return true;
+    }
+};
@@ -0,0 +1,159 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/runtime.h>
+
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <solutions/verify.h>
+#include <trace/trace.h>
+#include <trace/trace_buffer.h>
+#include <trace/trace_stream.h>
+
+/**
+ * Replays a recorded trace. The operations are decoded by a trace_stream
+ * ahead of the timed loop, which does no random number generation. The
+ * "decode" parameter is the time stalled waiting for the decoder, not the
+ * decoding cost: the empty solution stalls for nearly the whole decode,
+ * while a real solution rarely does, so after the empty row is subtracted
+ * its decode time is usually 0. A nonzero value means the solution
+ * outran the decoder. Decoding runs on its own thread, so insert, erase
+ * and at carry none of its cost.
+ */
+class trace_replay {
+    // Shared by the copies of the tester, a generated trace is made once.
+    struct source {
+        std::once_flag once;
+        std::function<std::vector<trace_op>()> generate;
+        std::shared_ptr<const trace_buffer> trace;
+    };
+
+    std::string name_;
+    std::shared_ptr<source> source_;
+    int checksum_ = 0;
+#ifdef VERIFY
+    std::vector<int> w;
+#endif
+
+    const trace_buffer& trace() {
+        source& s = *source_;
+        std::call_once(s.once, [&s]() {
+            if (!s.trace)
+                s.trace = std::make_shared<const trace_buffer>(s.generate());
+        });
+        return *s.trace;
+    }
+
+    explicit trace_replay(std::string name)
+        : name_(std::move(name)),
+          source_(std::make_shared<source>()) { }
+
+    void verify_replay() {
+#ifdef VERIFY
+        std::cerr << "Running verification solution on test " << name_ << std::endl;
+        test<verify>();
+#endif
+    }
+public:
+    // The generator is only called if the test is selected.
+    trace_replay(std::string name, std::function<std::vector<trace_op>()> generate)
+        : trace_replay(std::move(name)) {
+        source_->generate = std::move(generate);
+        verify_replay();
+    }
+
+    trace_replay(std::string name, std::vector<trace_op> ops)
+        : trace_replay(std::move(name), std::make_shared<const trace_buffer>(std::move(ops))) { }
+
+    trace_replay(std::string name, std::shared_ptr<const trace_buffer> trace)
+        : trace_replay(std::move(name)) {
+        source_->trace = std::move(trace);
+        verify_replay();
+    }
+
+    std::string name() const {
+        return name_;
+    }
+
+    void prepare() {
+        trace();
+    }
+
+    static constexpr speedtest::ParamList<4> params() {
+        return {{ "decode", "insert", "erase", "at" }};
+    }
+
+    template<class Solution>
+    bool test() {
+        Solution s;
+        int checksum = 0;
+        trace_stream stream(trace());
+
+        for (;;) {
+            const std::vector<decoded_op>* block;
+            MULTIPARAMTEST_INVOKE("decode", block = &stream.next();)
+            if (block->empty())
+                break;
+            for (const decoded_op& op : *block) {
+                switch (op.opcode) {
+                case trace_opcode::insert:
+                    MULTIPARAMTEST_INVOKE("insert", s.insert(op.position, op.value);)
+                    break;
+                case trace_opcode::erase:
+                    MULTIPARAMTEST_INVOKE("erase", s.erase(op.position);)
+                    break;
+                default:
+                    MULTIPARAMTEST_INVOKE("at", checksum ^= s.at(op.position);)
+                    break;
+                }
+            }
+        }
+        checksum_ = checksum;
+        if (!stream.ok()) {
+            std::cerr << "Error: trace " << name_ << ": " << stream.error() << std::endl;
+            return false;
+        }
+        long long final_size = stream.final_size();
+        speedtest::memory_checkpoint("end", final_size);
+
+#ifdef VERIFY
+        if (Solution::name() == "verify") {
+            w = (std::vector<int>)s;
+        } else {
+            for (int i = 0; i < final_size; i++) {
+                if (w[i] != s.at(i))
+                    return false;
+            }
+            if (w != (std::vector<int>)s)
+                return false;
+        }
+#endif
+
+        return true;
+    }
+};
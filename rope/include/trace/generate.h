@@ -0,0 +1,139 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Trace generators.
+ * Each generator draws the same random numbers in the same order as the
+ * tester of the same name, so replaying its trace repeats the workload
+ * with the RNG taken out of the timed loop.
+ */
+
+#ifndef TRACE_GENERATE_H_
+#define TRACE_GENERATE_H_
+
+#include <trace/trace.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace trace_gen {
+
+    inline std::uniform_int_distribution<int> value_dist() {
+        return std::uniform_int_distribution<int>(std::numeric_limits<int>::min(),
+                                                  std::numeric_limits<int>::max());
+    }
+
+    inline void random_updates(std::mt19937& rnd, int m, int cnt, std::vector<trace_op>& ops) {
+        auto dist = value_dist();
+        for (int i = 0; i < m; i++) {
+            int type;
+            if (cnt == 0)
+                type = 1;
+            else
+                type = rnd() % 2;
+            if (type == 1) {
+                int at = rnd() % (cnt + 1);
+                int x = dist(rnd);
+                ops.push_back(trace_op::make(trace_opcode::insert, at, x));
+                cnt++;
+            } else {
+                int at = rnd() % cnt;
+                ops.push_back(trace_op::make(trace_opcode::erase, at));
+                cnt--;
+            }
+        }
+    }
+
+    inline void appends(std::mt19937& rnd, int n, std::vector<trace_op>& ops) {
+        auto dist = value_dist();
+        for (int i = 0; i < n; i++)
+            ops.push_back(trace_op::make(trace_opcode::insert, i, dist(rnd)));
+    }
+
+    inline std::vector<trace_op> build(int seed, int n) {
+        std::mt19937 rnd(seed);
+        std::vector<trace_op> ops;
+        ops.reserve(n);
+        appends(rnd, n, ops);
+        return ops;
+    }
+
+    inline std::vector<trace_op> build_shuffle(int seed, int n) {
+        std::mt19937 rnd(seed);
+        auto dist = value_dist();
+        std::vector<trace_op> ops;
+        ops.reserve(n);
+        for (int i = 0; i < n; i++) {
+            int at = rnd() % (i + 1);
+            int x = dist(rnd);
+            ops.push_back(trace_op::make(trace_opcode::insert, at, x));
+        }
+        return ops;
+    }
+
+    inline std::vector<trace_op> insert_erase(int seed, int n) {
+        std::mt19937 rnd(seed);
+        std::vector<trace_op> ops;
+        ops.reserve(n);
+        random_updates(rnd, n, 0, ops);
+        return ops;
+    }
+
+    inline std::vector<trace_op> build_insert_erase(int seed, int n, int m) {
+        std::mt19937 rnd(seed);
+        std::vector<trace_op> ops;
+        ops.reserve(n + m);
+        appends(rnd, n, ops);
+        random_updates(rnd, m, n, ops);
+        return ops;
+    }
+
+    // Random inserts, erases and accesses, a third each, around a structure of size n.
+    inline std::vector<trace_op> steady_state(int seed, int n, int m) {
+        std::mt19937 rnd(seed);
+        auto dist = value_dist();
+        std::vector<trace_op> ops;
+        ops.reserve(m);
+        int cnt = n;
+        for (int i = 0; i < m; i++) {
+            int type = rnd() % 3;
+            if (cnt == 0)
+                type = 0;
+            if (type == 0) {
+                int at = rnd() % (cnt + 1);
+                ops.push_back(trace_op::make(trace_opcode::insert, at, dist(rnd)));
+                cnt++;
+            } else if (type == 1) {
+                ops.push_back(trace_op::make(trace_opcode::erase, rnd() % cnt));
+                cnt--;
+            } else {
+                ops.push_back(trace_op::make(trace_opcode::at, rnd() % cnt));
+            }
+        }
+        return ops;
+    }
+
+};
+
+#endif // TRACE_GENERATE_H_
@@ -0,0 +1,214 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Rope workload traces.
+ * A trace is a 16-byte header followed by fixed 8-byte records, so it
+ * can be read in one go or mapped into memory. Both are stored in the
+ * host byte order.
+ *
+ * Each record keeps the opcode in the high 3 bits of the first word,
+ * the position in the low 29 bits and the inserted value in the second
+ * word. Split and merge opcodes are reserved: the solutions don't share
+ * a split/merge interface yet, so the replay rejects them.
+ *
+ * load_trace reads a whole trace into memory, trace_buffer maps it.
+ */
+
+#ifndef TRACE_TRACE_H_
+#define TRACE_TRACE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+enum class trace_opcode : std::uint32_t {
+    insert = 0,
+    erase = 1,
+    at = 2,
+    split = 3,
+    merge = 4
+};
+
+struct trace_op {
+    static constexpr int opcode_shift = 29;
+    static constexpr std::uint32_t max_position = (1u << opcode_shift) - 1;
+
+    std::uint32_t code;
+    std::int32_t value;
+
+    trace_opcode opcode() const {
+        return static_cast<trace_opcode>(code >> opcode_shift);
+    }
+
+    int position() const {
+        return static_cast<int>(code & max_position);
+    }
+
+    // Positions must fit into the 29 bits below the opcode.
+    static trace_op make(trace_opcode op, int position, int value = 0) {
+        if (position < 0 || static_cast<std::uint32_t>(position) > max_position)
+            throw std::out_of_range("trace position " + std::to_string(position) + " does not fit into a record");
+        return { (static_cast<std::uint32_t>(op) << opcode_shift) | static_cast<std::uint32_t>(position),
+                 value };
+    }
+};
+
+static_assert(sizeof(trace_op) == 8, "trace records must be 8 bytes long");
+
+struct trace_header {
+    static constexpr const char* signature = "RTRC";
+    static constexpr std::uint32_t current_version = 1;
+
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t records;
+};
+
+static_assert(sizeof(trace_header) == 16, "trace header must be 16 bytes long");
+
+inline bool check_trace_header(const trace_header& header, std::string& error) {
+    if (std::memcmp(header.magic, trace_header::signature, 4) != 0) {
+        error = "not a rope trace";
+        return false;
+    }
+    if (header.version != trace_header::current_version) {
+        error = "unsupported trace version " + std::to_string(header.version);
+        return false;
+    }
+    return true;
+}
+
+inline bool load_trace(const std::string& path, std::vector<trace_op>& ops, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    trace_header header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        error = "cannot read the trace header";
+        return false;
+    }
+    if (!check_trace_header(header, error))
+        return false;
+    // Check the length before allocating for a corrupt record count.
+    in.seekg(0, std::ios::end);
+    std::uint64_t length = static_cast<std::uint64_t>(in.tellg()) - sizeof(header);
+    if (!in || length / sizeof(trace_op) < header.records) {
+        error = "the trace is truncated";
+        return false;
+    }
+    in.seekg(sizeof(header));
+    ops.resize(header.records);
+    if (!in.read(reinterpret_cast<char*>(ops.data()), header.records * sizeof(trace_op))) {
+        error = "the trace is truncated";
+        return false;
+    }
+    return true;
+}
+
+inline bool save_trace(const std::string& path, const std::vector<trace_op>& ops) {
+    std::ofstream out(path, std::ios::binary);
+    trace_header header;
+    std::memcpy(header.magic, trace_header::signature, 4);
+    header.version = trace_header::current_version;
+    header.records = ops.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(ops.data()), ops.size() * sizeof(trace_op));
+    return static_cast<bool>(out);
+}
+
+/**
+ * A rope that records every operation into a trace before forwarding it
+ * to the underlying solution. Wrap the service's rope into it to capture
+ * a production workload for trace_replay.
+ */
+template<class Solution>
+class trace_recorder {
+    Solution s_;
+    std::vector<trace_op> ops_;
+public:
+    trace_recorder() { }
+    trace_recorder(const trace_recorder&) = delete;
+    ~trace_recorder() = default;
+
+    void insert(int before, int value) {
+        ops_.push_back(trace_op::make(trace_opcode::insert, before, value));
+        s_.insert(before, value);
+    }
+
+    void erase(int where) {
+        ops_.push_back(trace_op::make(trace_opcode::erase, where));
+        s_.erase(where);
+    }
+
+    // Recorded as erases of the old contents followed by appends, the
+    // format has no bulk operation.
+    void build(const int *first, const int *last) {
+        for (int i = s_.size(); i > 0; i--)
+            ops_.push_back(trace_op::make(trace_opcode::erase, i - 1));
+        s_.build(first, last);
+        for (int i = 0; first + i != last; i++)
+            ops_.push_back(trace_op::make(trace_opcode::insert, i, first[i]));
+    }
+
+    int at(int index) {
+        ops_.push_back(trace_op::make(trace_opcode::at, index));
+        return s_.at(index);
+    }
+
+    // The scans are not recorded.
+    typedef typename Solution::iterator iterator;
+
+    int size() const {
+        return s_.size();
+    }
+
+    iterator begin() const {
+        return s_.begin();
+    }
+
+    iterator end() const {
+        return s_.end();
+    }
+
+    void copy_to(int *out) const {
+        s_.copy_to(out);
+    }
+
+    operator std::vector<int>() {
+        return (std::vector<int>)s_;
+    }
+
+    const std::vector<trace_op>& ops() const {
+        return ops_;
+    }
+
+    bool save(const std::string& path) const {
+        return save_trace(path, ops_);
+    }
+
+    static std::string name() { return Solution::name(); }
+};
+
+#endif // TRACE_TRACE_H_
@@ -0,0 +1,121 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TRACE_TRACE_BUFFER_H_
+#define TRACE_TRACE_BUFFER_H_
+
+#include <trace/trace.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * The records of a trace, either held in memory or mapped from a file.
+ * A mapped file is read sequentially by the kernel and only the pages
+ * around the replay position have to stay resident.
+ */
+class trace_buffer {
+    std::vector<trace_op> owned_;
+    void* map_ = MAP_FAILED;
+    std::size_t map_length_ = 0;
+    const trace_op* ops_ = nullptr;
+    std::size_t size_ = 0;
+public:
+    trace_buffer() { }
+
+    explicit trace_buffer(std::vector<trace_op> ops)
+        : owned_(std::move(ops)),
+          ops_(owned_.data()),
+          size_(owned_.size()) { }
+
+    trace_buffer(const trace_buffer&) = delete;
+    trace_buffer& operator=(const trace_buffer&) = delete;
+
+    ~trace_buffer() {
+        if (map_ != MAP_FAILED)
+            munmap(map_, map_length_);
+    }
+
+    bool map(const std::string& path, std::string& error) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = "cannot open the file";
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (std::size_t)st.st_size < sizeof(trace_header)) {
+            close(fd);
+            error = "cannot read the trace header";
+            return false;
+        }
+        map_length_ = st.st_size;
+        map_ = mmap(nullptr, map_length_, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map_ == MAP_FAILED) {
+            error = "cannot map the file";
+            return false;
+        }
+        madvise(map_, map_length_, MADV_SEQUENTIAL);
+
+        const trace_header* header = static_cast<const trace_header*>(map_);
+        if (!check_trace_header(*header, error))
+            return false;
+        if ((map_length_ - sizeof(trace_header)) / sizeof(trace_op) < header->records) {
+            error = "the trace is truncated";
+            return false;
+        }
+        ops_ = reinterpret_cast<const trace_op*>(header + 1);
+        size_ = header->records;
+        return true;
+    }
+
+    const trace_op* data() const {
+        return ops_;
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    bool mapped() const {
+        return map_ != MAP_FAILED;
+    }
+
+    // Passes the advice for the pages of the given records to the kernel.
+    void advise(std::size_t first, std::size_t count, int advice) const {
+        if (!mapped() || count == 0)
+            return;
+        static const std::size_t page = sysconf(_SC_PAGESIZE);
+        std::size_t begin = reinterpret_cast<std::size_t>(ops_ + first) & ~(page - 1);
+        std::size_t end = reinterpret_cast<std::size_t>(ops_ + first + count);
+        madvise(reinterpret_cast<void*>(begin), end - begin, advice);
+    }
+};
+
+#endif // TRACE_TRACE_BUFFER_H_
@@ -0,0 +1,182 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TRACE_TRACE_STREAM_H_
+#define TRACE_TRACE_STREAM_H_
+
+#include <trace/trace.h>
+#include <trace/trace_buffer.h>
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+
+struct decoded_op {
+    trace_opcode opcode;
+    int position;
+    int value;
+};
+
+/**
+ * Decodes a trace in blocks on a background thread, a few blocks ahead
+ * of the reader. The decoder checks every record against the current
+ * size, so a malformed trace stops the stream instead of crashing the
+ * solution. Pages of a mapped trace are requested before they are
+ * decoded and released after that.
+ */
+class trace_stream {
+public:
+    static constexpr std::size_t block_size = 1 << 16;
+    static constexpr std::size_t depth = 4;
+
+    explicit trace_stream(const trace_buffer& trace)
+        : trace_(trace),
+          decoder_([this]() { decode(); }) { }
+
+    trace_stream(const trace_stream&) = delete;
+
+    ~trace_stream() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        changed_.notify_all();
+        decoder_.join();
+    }
+
+    // The next block of operations, empty at the end of the trace.
+    const std::vector<decoded_op>& next() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (holding_) {
+            slots_[read_ % depth].full = false;
+            read_++;
+            holding_ = false;
+            changed_.notify_all();
+        }
+        changed_.wait(lock, [this]() { return slots_[read_ % depth].full || finished_ == read_; });
+        if (!slots_[read_ % depth].full)
+            return none_;
+        holding_ = true;
+        return slots_[read_ % depth].ops;
+    }
+
+    // Valid after the end of the stream.
+    bool ok() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_.empty();
+    }
+
+    const std::string& error() const {
+        return error_;
+    }
+
+    // The size of the structure after the replayed operations.
+    long long final_size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+
+private:
+    struct slot {
+        std::vector<decoded_op> ops;
+        bool full = false;
+    };
+
+    void decode() {
+        long long size = 0;
+        std::size_t block = 0;
+        std::string error;
+        for (std::size_t first = 0; first < trace_.size() && error.empty(); first += block_size, block++) {
+            std::size_t count = std::min(std::size_t(block_size), trace_.size() - first);
+            trace_.advise(first + count, std::min(std::size_t(block_size), trace_.size() - first - count), MADV_WILLNEED);
+
+            slot& s = slots_[block % depth];
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                changed_.wait(lock, [this, &s]() { return !s.full || stop_; });
+                if (stop_)
+                    return;
+            }
+
+            s.ops.clear();
+            const trace_op* ops = trace_.data() + first;
+            for (std::size_t i = 0; i != count; i++) {
+                decoded_op op{ ops[i].opcode(), ops[i].position(), ops[i].value };
+                bool valid;
+                switch (op.opcode) {
+                case trace_opcode::insert:
+                    valid = op.position <= size++;
+                    break;
+                case trace_opcode::erase:
+                    valid = op.position < size--;
+                    break;
+                case trace_opcode::at:
+                    valid = op.position < size;
+                    break;
+                default:
+                    valid = false;
+                    break;
+                }
+                if (!valid) {
+                    error = "record " + std::to_string(first + i) + " is invalid";
+                    break;
+                }
+                s.ops.push_back(op);
+            }
+            trace_.advise(first, count, MADV_DONTNEED);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            s.full = true;
+            changed_.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = block;
+        size_ = size;
+        error_ = error;
+        changed_.notify_all();
+    }
+
+    const trace_buffer& trace_;
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::array<slot, depth> slots_;
+    std::size_t read_ = 0;
+    bool holding_ = false;
+    // The number of blocks, known when the decoder is done.
+    std::size_t finished_ = static_cast<std::size_t>(-1);
+    bool stop_ = false;
+    long long size_ = 0;
+    std::string error_;
+    const std::vector<decoded_op> none_;
+    std::thread decoder_;
+};
+
+#endif // TRACE_TRACE_STREAM_H_
@@ -41,35 +41,103 @@
  *     std::pair<generic_solution, generic_solution> split(int left);
  *     // Merge two structures into one, lt would be the first.
  *     static generic_solution merge(const generic_solution&& lt, const generic_solution&& rt);
+ *     // Replace the contents with the values of the range.
+ *     void build(const int* first, const int* last);
  *     // Access element at index.
  *     int at(int index);
+ *     // Number of elements.
+ *     int size() const;
+ *     // Forward iterators over the values in order.
+ *     iterator begin() const;
+ *     iterator end() const;
+ *     // Write the values in order, out must have room for size() values.
+ *     void copy_to(int* out) const;
  *     // Convert to std::vector<int>.
  *     operator std::vector<int>();
  *     // Solution name
  *     static std::string name();
  * };
+ *
+ * The trace_replay test replays insert_erase from a pregenerated trace.
+ * Pass --trace=FILE to replay a recorded trace instead, see
+ * trace/trace.h for the format and rope_trace for the generator. The
+ * file is mapped rather than read, so it may be larger than the memory.
+ *
+ * The steady_state sweep times single operations on structures of 2^10
+ * to 2^17 elements, where the blocked ropes compete with the trees.
  */
 
 
 #include <speedtest/speedtest.h>
+#include <speedtest/sweep.h>
 
 #include <tests/build_long_struct.h>
 #include <tests/build_shuffle.h>
 #include <tests/insert_erase.h>
 #include <tests/build_insert_erase.h>
+#include <tests/trace_replay.h>
+#include <tests/steady_state.h>
+#include <tests/bulk_build.h>
+#include <tests/scan.h>
+
+#include <trace/generate.h>
 
 #include <solutions/empty.h>
 #include <solutions/treap.h>
+#include <solutions/soa_treap.h>
+#include <solutions/index_treap.h>
 #include <solutions/splay.h>
 #include <solutions/avl.h>
+#include <solutions/btree.h>
+#include <solutions/skip_list.h>
+#include <solutions/blocked.h>
 
+#include <cstring>
+#include <iostream>
+#include <memory>
 #include <random>
+#include <string>
+#include <vector>
+
+// Removes --trace=FILE from the arguments and builds the tester it asks for.
+trace_replay make_trace_replay(int& argc, char *argv[]) {
+    std::string path;
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--trace=", 8) == 0)
+            path = argv[i] + 8;
+        else
+            argv[kept++] = argv[i];
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+
+    if (path.empty())
+        return trace_replay("trace_replay", []() { return trace_gen::insert_erase(179, 5e6); });
+
+    auto trace = std::make_shared<trace_buffer>();
+    std::string error;
+    if (!trace->map(path, error)) {
+        std::cerr << "Error: cannot load the trace from " << path << ": " << error << std::endl;
+        exit(1);
+    }
+    std::size_t slash = path.find_last_of('/');
+    return trace_replay(slash == std::string::npos ? path : path.substr(slash + 1), std::move(trace));
+}
 
 int main(int argc, char *argv[]) {
+    trace_replay replay = make_trace_replay(argc, argv);
+
     speedtest::init(speedtest::testers(build_long_struct(179, 1e6),
                                        build_shuffle(179, 1e6),
                                        insert_erase(179, 5e6),
-                                       build_insert_erase(179, 1e6, 1e6)),
+                                       build_insert_erase(179, 1e6, 1e6),
+                                       bulk_build(179, 1e6),
+                                       scan(179, 1e6, 10),
+                                       std::move(replay),
+                                       speedtest::sweep("steady_state", 1 << 10, 1 << 17, 2, [](long long n) {
+                                           return steady_state(179, n, 1e5);
+                                       })),
                     speedtest::solutions<
                             olymp_treap<c_rnd_eng>,
                             olymp_treap<std::mt19937>,
@@ -77,8 +145,20 @@ int main(int argc, char *argv[]) {
                             opt_treap<std::mt19937>,
                             nr_treap<c_rnd_eng>,
                             nr_treap<std::mt19937>,
+                            soa_treap<std::mt19937>,
+                            index_treap<std::mt19937>,
                             splay_tree,
-                            avl_tree
+                            avl_tree,
+                            skip_list<std::mt19937>,
+                            blocked_rope<512>,
+                            blocked_rope<512, true>,
+                            btree_rope<64>,
+                            btree_rope<256>,
+                            olymp_treap<std::mt19937, slab_alloc>,
+                            opt_treap<std::mt19937, slab_alloc>,
+                            nr_treap<std::mt19937, slab_alloc>,
+                            basic_splay_tree<slab_alloc>,
+                            basic_avl_tree<slab_alloc>
                     >(),
                     speedtest::empty_solution<empty>());
 
@@ -0,0 +1,61 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Rope range operations speedtest.
+ * The ropes with a range aggregate answer sum(l, r) and min(l, r) and
+ * apply add(l, r, delta) and reverse(l, r) on the half-open range
+ * [l, r), in addition to the interface described in main.cpp:
+ *
+ *     long long sum(int l, int r);
+ *     int min(int l, int r);
+ *     void add(int l, int r, int delta);
+ *     void reverse(int l, int r);
+ *
+ * The aggregates are in solutions/aggregate.h. The ropes in the main
+ * speedtest keep the default no_aggregate and don't pay for them.
+ */
+
+#include <speedtest/speedtest.h>
+
+#include <tests/range_ops.h>
+
+#include <solutions/empty.h>
+#include <solutions/treap.h>
+#include <solutions/splay.h>
+
+#include <random>
+
+int main(int argc, char *argv[]) {
+    speedtest::init(speedtest::testers(range_ops(179, 1e5, 1e6)),
+                    speedtest::solutions<
+                            olymp_treap<std::mt19937, heap_alloc, range_aggregate>,
+                            olymp_treap<std::mt19937, slab_alloc, range_aggregate>,
+                            basic_splay_tree<heap_alloc, range_aggregate>,
+                            basic_splay_tree<slab_alloc, range_aggregate>
+                    >(),
+                    speedtest::empty_solution<empty>());
+
+    speedtest::run(argc, argv);
+    return 0;
+}
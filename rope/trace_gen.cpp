@@ -0,0 +1,85 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Writes the workloads of the rope testers as traces.
+ * Usage: rope_trace WORKLOAD SEED N [M] OUTPUT
+ * where WORKLOAD is build, build_shfl, insert_erase or build_insert_erase.
+ */
+
+#include <trace/generate.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " WORKLOAD SEED N [M] OUTPUT\n"
+              << "WORKLOAD is one of build, build_shfl, insert_erase, build_insert_erase;\n"
+              << "M is only used by build_insert_erase." << std::endl;
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 5)
+        usage(argv[0]);
+
+    std::string workload = argv[1];
+    int seed = std::atoi(argv[2]);
+    long long n = std::atoll(argv[3]);
+    long long m = workload == "build_insert_erase" && argc == 6 ? std::atoll(argv[4]) : 0;
+    // Every insert may grow the structure, its size bounds the positions.
+    if (n < 0 || m < 0 || n + m > trace_op::max_position) {
+        std::cerr << "Error: N + M must be between 0 and " << trace_op::max_position
+                  << ", the largest position a record can hold" << std::endl;
+        return 1;
+    }
+    std::vector<trace_op> ops;
+
+    if (workload == "build_insert_erase") {
+        if (argc != 6)
+            usage(argv[0]);
+        ops = trace_gen::build_insert_erase(seed, n, m);
+    } else {
+        if (argc != 5)
+            usage(argv[0]);
+        if (workload == "build")
+            ops = trace_gen::build(seed, n);
+        else if (workload == "build_shfl")
+            ops = trace_gen::build_shuffle(seed, n);
+        else if (workload == "insert_erase")
+            ops = trace_gen::insert_erase(seed, n);
+        else
+            usage(argv[0]);
+    }
+
+    const char* output = argv[argc - 1];
+    if (!save_trace(output, ops)) {
+        std::cerr << "Error: cannot write the trace to " << output << std::endl;
+        return 1;
+    }
+    std::cout << ops.size() << " records written to " << output << std::endl;
+    return 0;
+}
@@ -21,6 +21,8 @@
  * SOFTWARE.
  */
 
+#include <speedtest/runtime.h>
+
 #include <random>
 #include <limits>
 #include <algorithm>
@@ -42,6 +44,7 @@ public:
     template<class Solution>
     bool test() {
         Solution s(n_);
+        speedtest::memory_checkpoint("build", n_);
         if (test_correctness_) {
             std::vector<int> v(n_, INF);
             for (int i = 0; i < m_; i++) {
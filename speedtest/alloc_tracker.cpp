@@ -0,0 +1,243 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/alloc_tracker.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include <malloc.h>
+
+namespace speedtest {
+    namespace {
+        std::atomic<bool> tracking_enabled(false);
+
+        // Plain data, so that accessing it from operator new never allocates.
+        struct TrackerState {
+            bool active;
+            long long live_bytes;
+            AllocationStats* stats;
+        };
+        thread_local TrackerState tracker = { false, 0, nullptr };
+        thread_local AllocationStats current_stats;
+
+        int size_bucket(std::size_t size) {
+            int bucket = 0;
+            while (size > 1 && bucket + 1 < AllocationStats::histogram_buckets) {
+                size >>= 1;
+                bucket++;
+            }
+            return bucket;
+        }
+
+        void on_alloc(void* p, std::size_t size) {
+            if (!tracker.active)
+                return;
+            AllocationStats& stats = *tracker.stats;
+            stats.count++;
+            stats.bytes += size;
+            stats.size_histogram[size_bucket(size)]++;
+            tracker.live_bytes += malloc_usable_size(p);
+            stats.peak_bytes = std::max(stats.peak_bytes, tracker.live_bytes);
+        }
+
+        void on_free(void* p) {
+            if (tracker.active)
+                tracker.live_bytes -= malloc_usable_size(p);
+        }
+
+        void* tracked_alloc(std::size_t size) {
+            void* p = std::malloc(size == 0 ? 1 : size);
+            if (p != nullptr && tracking_enabled.load(std::memory_order_relaxed))
+                on_alloc(p, size);
+            return p;
+        }
+
+        void tracked_free(void* p) {
+            if (p != nullptr && tracking_enabled.load(std::memory_order_relaxed))
+                on_free(p);
+            std::free(p);
+        }
+
+        void* alloc_or_throw(std::size_t size) {
+            while (true) {
+                void* p = tracked_alloc(size);
+                if (p != nullptr)
+                    return p;
+                std::new_handler handler = std::get_new_handler();
+                if (handler == nullptr)
+                    throw std::bad_alloc();
+                handler();
+            }
+        }
+    };
+
+    void AllocationStats::remove_baseline(const AllocationStats& base) {
+        if (!valid || !base.valid)
+            return;
+        count = std::max(0ll, count - base.count);
+        bytes = std::max(0ll, bytes - base.bytes);
+        for (int i = 0; i < histogram_buckets; i++)
+            size_histogram[i] = std::max(0ll, size_histogram[i] - base.size_histogram[i]);
+        for (auto& checkpoint : checkpoints) {
+            for (auto& base_checkpoint : base.checkpoints) {
+                if (base_checkpoint.name == checkpoint.name)
+                    checkpoint.live_bytes = std::max(0ll, checkpoint.live_bytes - base_checkpoint.live_bytes);
+            }
+        }
+    }
+
+    int AllocationStats::top_bucket() const {
+        int ret = -1;
+        for (int i = 0; i < histogram_buckets; i++) {
+            if (size_histogram[i] > 0 && (ret == -1 || size_histogram[i] > size_histogram[ret]))
+                ret = i;
+        }
+        return ret;
+    }
+
+    std::string AllocationStats::bucket_name(int bucket) {
+        if (bucket == 0)
+            return "0-1 B";
+        return std::to_string(1ll << bucket) + "-" + std::to_string((1ll << (bucket + 1)) - 1) + " B";
+    }
+
+    void AllocationStats::save(std::ostream& out) const {
+        out << valid << ' ' << count << ' ' << bytes << ' ' << peak_bytes << ' ';
+        for (int i = 0; i < histogram_buckets; i++)
+            out << size_histogram[i] << ' ';
+        out << checkpoints.size() << ' ';
+        for (auto& checkpoint : checkpoints)
+            out << checkpoint.name.size() << ' ' << checkpoint.name << ' '
+                << checkpoint.live_bytes << ' ' << checkpoint.elements << ' ';
+    }
+
+    bool AllocationStats::load(std::istream& in) {
+        if (!(in >> valid >> count >> bytes >> peak_bytes))
+            return false;
+        for (int i = 0; i < histogram_buckets; i++) {
+            if (!(in >> size_histogram[i]))
+                return false;
+        }
+        std::size_t n;
+        if (!(in >> n))
+            return false;
+        checkpoints.resize(n);
+        for (auto& checkpoint : checkpoints) {
+            std::size_t len;
+            if (!(in >> len) || in.get() != ' ')
+                return false;
+            checkpoint.name.resize(len);
+            if (len != 0 && !in.read(&checkpoint.name[0], len))
+                return false;
+            if (!(in >> checkpoint.live_bytes >> checkpoint.elements))
+                return false;
+        }
+        return true;
+    }
+
+    void enable_allocation_tracking() {
+        tracking_enabled = true;
+    }
+
+    void start_allocation_tracking() {
+        current_stats = AllocationStats();
+        current_stats.valid = tracking_enabled;
+        tracker.stats = &current_stats;
+        tracker.live_bytes = 0;
+        tracker.active = tracking_enabled;
+    }
+
+    AllocationStats stop_allocation_tracking() {
+        tracker.active = false;
+        return current_stats;
+    }
+
+    void memory_checkpoint(const std::string& name, long long elements) {
+        if (!tracker.active)
+            return;
+        // The checkpoint itself must not be counted.
+        tracker.active = false;
+        MemoryCheckpoint checkpoint{ name, tracker.live_bytes, elements };
+        auto& checkpoints = current_stats.checkpoints;
+        auto it = std::find_if(checkpoints.begin(), checkpoints.end(),
+                               [&name](const MemoryCheckpoint& c) { return c.name == name; });
+        if (it == checkpoints.end())
+            checkpoints.push_back(checkpoint);
+        else
+            *it = checkpoint;
+        tracker.active = true;
+    }
+};
+
+void* operator new(std::size_t size) {
+    return speedtest::alloc_or_throw(size);
+}
+
+void* operator new[](std::size_t size) {
+    return speedtest::alloc_or_throw(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return speedtest::alloc_or_throw(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return speedtest::alloc_or_throw(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept {
+    speedtest::tracked_free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    speedtest::tracked_free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    speedtest::tracked_free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    speedtest::tracked_free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    speedtest::tracked_free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    speedtest::tracked_free(p);
+}
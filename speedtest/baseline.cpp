@@ -0,0 +1,105 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/baseline.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+namespace speedtest {
+    namespace {
+        // Splits a CSV line, quoted fields may contain commas and doubled quotes.
+        std::vector<std::string> split_csv(const std::string& line) {
+            std::vector<std::string> ret(1);
+            bool quoted = false;
+            for (std::size_t i = 0; i < line.size(); i++) {
+                char c = line[i];
+                if (quoted) {
+                    if (c != '"')
+                        ret.back() += c;
+                    else if (i + 1 < line.size() && line[i + 1] == '"')
+                        ret.back() += line[++i];
+                    else
+                        quoted = false;
+                } else if (c == '"') {
+                    quoted = true;
+                } else if (c == ',') {
+                    ret.emplace_back();
+                } else {
+                    ret.back() += c;
+                }
+            }
+            return ret;
+        }
+    };
+
+    bool Baseline::load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in)
+            return false;
+        std::string line;
+        bool header = true;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#')
+                continue;
+            if (header) {
+                header = false;
+                continue;
+            }
+            // solution, test, param, status, trial, time_ns
+            std::vector<std::string> fields = split_csv(line);
+            if (fields.size() < 6)
+                return false;
+            if (fields[3] != "ok" || fields[5].empty())
+                continue;
+            Samples& samples = cells_[std::make_tuple(fields[0], fields[1], fields[2])];
+            samples.push_back(std::chrono::nanoseconds(std::atoll(fields[5].c_str())));
+        }
+        return !header;
+    }
+
+    Comparison Baseline::compare(const std::string& solution, const std::string& test, const std::string& param,
+                                 const Samples& samples) const {
+        Comparison ret;
+        auto it = cells_.find(std::make_tuple(solution, test, param));
+        if (it == cells_.end() || samples.empty())
+            return ret;
+        double base = (double)median(it->second).count();
+        double current = (double)median(samples).count();
+        if (current <= 0)
+            return ret;
+        ret.speedup = base / current;
+        ret.p_value = mann_whitney_p(it->second, samples);
+        return ret;
+    }
+
+    std::size_t Baseline::min_samples() const {
+        std::size_t ret = 0;
+        for (auto& cell : cells_) {
+            if (ret == 0 || cell.second.size() < ret)
+                ret = cell.second.size();
+        }
+        return ret;
+    }
+};
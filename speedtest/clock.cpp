@@ -0,0 +1,95 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/clock.h>
+
+#include <thread>
+
+#ifdef SPEEDTEST_HAS_TSC
+#include <cpuid.h>
+#endif
+
+namespace speedtest {
+    ClockBackend clock_backend = ClockBackend::Chrono;
+    double ns_per_tick = 1;
+
+    bool invariant_tsc_available() {
+#ifdef SPEEDTEST_HAS_TSC
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007)
+            return false;
+        if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+            return false;
+        return (edx >> 8) & 1;
+#else
+        return false;
+#endif
+    }
+
+    namespace {
+        // Nanoseconds per tick, measured over a few intervals of steady_clock. The
+        // shortest interval is the least disturbed by preemption.
+        double calibrate_tsc() {
+#ifdef SPEEDTEST_HAS_TSC
+            double best = 0;
+            std::chrono::nanoseconds best_elapsed = std::chrono::nanoseconds::max();
+            for (int i = 0; i < 5; i++) {
+                auto t1 = std::chrono::steady_clock::now();
+                std::uint64_t c1 = __rdtsc();
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                auto t2 = std::chrono::steady_clock::now();
+                std::uint64_t c2 = __rdtsc();
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1);
+                if (elapsed < best_elapsed) {
+                    best_elapsed = elapsed;
+                    best = (double)elapsed.count() / (c2 - c1);
+                }
+            }
+            return best;
+#else
+            return 0;
+#endif
+        }
+    };
+
+    bool select_clock(ClockBackend backend) {
+        clock_backend = ClockBackend::Chrono;
+        ns_per_tick = 1;
+        if (backend == ClockBackend::Chrono)
+            return true;
+        if (!invariant_tsc_available())
+            return false;
+        double calibrated = calibrate_tsc();
+        if (calibrated <= 0)
+            return false;
+        ns_per_tick = calibrated;
+        clock_backend = ClockBackend::TSC;
+        return true;
+    }
+
+    std::string clock_name() {
+        if (clock_backend == ClockBackend::TSC)
+            return "tsc";
+        return "chrono";
+    }
+};
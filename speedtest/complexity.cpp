@@ -0,0 +1,152 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/complexity.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace speedtest {
+    namespace {
+        struct Model {
+            const char* name;
+            std::function<double(double)> log_f;
+        };
+
+        const std::vector<Model> models = {
+            { "1", [](double) { return 0.0; } },
+            { "log n", [](double n) { return std::log(std::log2(n)); } },
+            { "n", [](double n) { return std::log(n); } },
+            { "n log n", [](double n) { return std::log(n) + std::log(std::log2(n)); } },
+            { "n log^2 n", [](double n) { return std::log(n) + 2 * std::log(std::log2(n)); } },
+            { "n^2", [](double n) { return 2 * std::log(n); } },
+            { "n^3", [](double n) { return 3 * std::log(n); } }
+        };
+    };
+
+    std::vector<long long> geometric_sizes(long long min_n, long long max_n, double factor) {
+        std::vector<long long> ret;
+        if (factor <= 1)
+            factor = 2;
+        for (double n = std::max(1ll, min_n); n <= max_n * (1 + 1e-9); n *= factor) {
+            long long size = std::llround(n);
+            if (ret.empty() || ret.back() != size)
+                ret.push_back(size);
+        }
+        return ret;
+    }
+
+    ComplexityFit fit_complexity(const std::vector<double>& sizes, const std::vector<double>& seconds) {
+        ComplexityFit ret;
+        std::vector<double> x, y;
+        for (std::size_t i = 0; i != sizes.size() && i != seconds.size(); i++) {
+            if (sizes[i] > 1 && seconds[i] > 0) {
+                x.push_back(sizes[i]);
+                y.push_back(std::log(seconds[i]));
+            }
+        }
+        std::size_t k = x.size();
+        if (k < 2)
+            return ret;
+
+        double mean_x = 0, mean_y = 0;
+        for (std::size_t i = 0; i != k; i++) {
+            mean_x += std::log(x[i]) / k;
+            mean_y += y[i] / k;
+        }
+        double sxy = 0, sxx = 0;
+        for (std::size_t i = 0; i != k; i++) {
+            sxy += (std::log(x[i]) - mean_x) * (y[i] - mean_y);
+            sxx += (std::log(x[i]) - mean_x) * (std::log(x[i]) - mean_x);
+        }
+        if (sxx == 0)
+            return ret;
+        ret.valid = true;
+        ret.exponent = sxy / sxx;
+
+        // The constant minimizing the squared error in log space is the geometric mean of time / model(n).
+        ret.error = std::numeric_limits<double>::infinity();
+        for (auto& model : models) {
+            double log_c = 0;
+            for (std::size_t i = 0; i != k; i++)
+                log_c += (y[i] - model.log_f(x[i])) / k;
+            double sq = 0;
+            for (std::size_t i = 0; i != k; i++) {
+                double d = y[i] - model.log_f(x[i]) - log_c;
+                sq += d * d;
+            }
+            double error = std::sqrt(sq / k);
+            if (error < ret.error) {
+                ret.error = error;
+                ret.model = model.name;
+                ret.constant = std::exp(log_c);
+            }
+        }
+        return ret;
+    }
+
+    std::vector<double> crossovers(const std::vector<double>& sizes, const std::vector<double>& a,
+                                   const std::vector<double>& b) {
+        std::vector<double> ret;
+        for (std::size_t i = 0; i + 1 < sizes.size() && i + 1 < a.size() && i + 1 < b.size(); i++) {
+            if (a[i] <= 0 || b[i] <= 0 || a[i + 1] <= 0 || b[i + 1] <= 0)
+                continue;
+            double d1 = std::log(a[i] / b[i]);
+            double d2 = std::log(a[i + 1] / b[i + 1]);
+            if (d1 == 0 || d1 * d2 >= 0)
+                continue;
+            double l1 = std::log(sizes[i]), l2 = std::log(sizes[i + 1]);
+            ret.push_back(std::exp(l1 + (l2 - l1) * d1 / (d1 - d2)));
+        }
+        return ret;
+    }
+
+    void SweepReport::analyze() {
+        std::vector<double> n(sizes.begin(), sizes.end());
+        for (auto& row : rows) {
+            if (row.exec_result)
+                row.fit = fit_complexity(n, row.seconds);
+        }
+        crossovers.clear();
+        for (std::size_t i = 0; i != rows.size(); i++) {
+            for (std::size_t j = i + 1; j != rows.size(); j++) {
+                if (!rows[i].exec_result || !rows[j].exec_result)
+                    continue;
+                for (double size : speedtest::crossovers(n, rows[i].seconds, rows[j].seconds)) {
+                    // Below the size, the sign of log(a / b) is the one at the previous sweep point.
+                    std::size_t k = 0;
+                    while (k + 1 < n.size() && n[k + 1] < size)
+                        k++;
+                    bool a_faster_below = rows[i].seconds[k] < rows[j].seconds[k];
+                    crossovers.push_back(Crossover{
+                        a_faster_below ? rows[i].solution_name : rows[j].solution_name,
+                        a_faster_below ? rows[j].solution_name : rows[i].solution_name,
+                        size
+                    });
+                }
+            }
+        }
+    }
+};
@@ -0,0 +1,105 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/environment.h>
+
+#include <ctime>
+#include <fstream>
+#include <thread>
+
+#include <sys/utsname.h>
+#include <unistd.h>
+
+// Normally defined by the build system.
+#ifndef SPEEDTEST_GIT_REVISION
+#define SPEEDTEST_GIT_REVISION ""
+#endif
+#ifndef SPEEDTEST_CXX_FLAGS
+#define SPEEDTEST_CXX_FLAGS ""
+#endif
+#ifndef SPEEDTEST_BUILD_TYPE
+#define SPEEDTEST_BUILD_TYPE ""
+#endif
+
+namespace speedtest {
+    namespace {
+        std::string cpu_model() {
+            std::ifstream in("/proc/cpuinfo");
+            std::string line;
+            while (std::getline(in, line)) {
+                if (line.compare(0, 10, "model name") != 0)
+                    continue;
+                std::size_t pos = line.find(':');
+                if (pos == std::string::npos)
+                    break;
+                pos = line.find_first_not_of(' ', pos + 1);
+                return pos == std::string::npos ? "" : line.substr(pos);
+            }
+            return "";
+        }
+
+        std::string read_line(const std::string& path) {
+            std::ifstream in(path);
+            std::string line;
+            std::getline(in, line);
+            return line;
+        }
+
+        std::string current_date() {
+            std::time_t now = std::time(nullptr);
+            char buf[64];
+            if (std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now)) == 0)
+                return "";
+            return buf;
+        }
+    };
+
+    std::vector<std::pair<std::string, std::string> > environment_info() {
+        std::string hostname, kernel;
+        char host[256];
+        if (gethostname(host, sizeof(host)) == 0) {
+            host[sizeof(host) - 1] = '\0';
+            hostname = host;
+        }
+        utsname un;
+        if (uname(&un) == 0)
+            kernel = std::string(un.sysname) + " " + un.release;
+
+        return {
+            { "date", current_date() },
+            { "hostname", hostname },
+            { "kernel", kernel },
+            { "cpu_model", cpu_model() },
+            { "cpus", std::to_string(std::thread::hardware_concurrency()) },
+            { "governor", read_line("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor") },
+#ifdef __VERSION__
+            { "compiler", __VERSION__ },
+#else
+            { "compiler", "" },
+#endif
+            { "flags", SPEEDTEST_CXX_FLAGS },
+            { "build_type", SPEEDTEST_BUILD_TYPE },
+            { "git_revision", SPEEDTEST_GIT_REVISION }
+        };
+    }
+};
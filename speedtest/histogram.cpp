@@ -0,0 +1,81 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/histogram.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace speedtest {
+    LatencyHistogram::LatencyHistogram() : counts_(num_buckets), total_(0), max_(0) {}
+
+    void LatencyHistogram::add(const LatencyHistogram& other) {
+        for (int i = 0; i < num_buckets; i++)
+            counts_[i] += other.counts_[i];
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    std::uint64_t LatencyHistogram::highest_equivalent(int index) {
+        if (index < 2 * sub_buckets)
+            return index;
+        int shift = index / sub_buckets - 1;
+        std::uint64_t sub = index % sub_buckets + sub_buckets;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::uint64_t LatencyHistogram::quantile(double q) const {
+        if (total_ == 0)
+            return 0;
+        std::uint64_t rank = std::max<std::uint64_t>(1, (std::uint64_t)std::ceil(q * total_));
+        std::uint64_t seen = 0;
+        for (int i = 0; i < num_buckets; i++) {
+            seen += counts_[i];
+            if (seen >= rank)
+                return std::min(highest_equivalent(i), max_);
+        }
+        return max_;
+    }
+
+    void LatencyHistogram::save(std::ostream& out) const {
+        int nonzero = std::count_if(counts_.begin(), counts_.end(), [](std::uint64_t c) { return c != 0; });
+        out << total_ << ' ' << max_ << ' ' << nonzero << ' ';
+        for (int i = 0; i < num_buckets; i++) {
+            if (counts_[i] != 0)
+                out << i << ' ' << counts_[i] << ' ';
+        }
+    }
+
+    bool LatencyHistogram::load(std::istream& in) {
+        int nonzero;
+        if (!(in >> total_ >> max_ >> nonzero))
+            return false;
+        std::fill(counts_.begin(), counts_.end(), 0);
+        for (int j = 0; j < nonzero; j++) {
+            int i;
+            if (!(in >> i) || i < 0 || i >= num_buckets || !(in >> counts_[i]))
+                return false;
+        }
+        return true;
+    }
+};
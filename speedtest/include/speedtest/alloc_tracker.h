@@ -0,0 +1,88 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_ALLOC_TRACKER_H_
+#define SPEEDTEST_ALLOC_TRACKER_H_
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace speedtest {
+    // Live heap memory at a point of a test, see memory_checkpoint().
+    struct MemoryCheckpoint {
+        std::string name;
+        long long live_bytes;
+        long long elements;
+
+        // Negative if there are no elements.
+        double bytes_per_element() const {
+            return elements > 0 ? (double)live_bytes / elements : -1;
+        }
+    };
+
+    // Heap allocations made through operator new by a single thread, which libspeedtest replaces.
+    struct AllocationStats {
+        // Bucket k counts the allocations of [2^k, 2^(k+1)) bytes, bucket 0 also counts empty ones.
+        static const int histogram_buckets = 48;
+
+        bool valid = false;
+        long long count = 0;
+        // Requested bytes.
+        long long bytes = 0;
+        // Maximal number of bytes live at once counting from the start of tracking,
+        // as reported by malloc_usable_size().
+        long long peak_bytes = 0;
+        long long size_histogram[histogram_buckets] = {};
+        // The last checkpoint of every name, in the order of the first ones.
+        std::vector<MemoryCheckpoint> checkpoints;
+
+        // Subtracts the allocations of the tester itself, measured on the empty solution.
+        // The peak is kept: it is not known whether the tester's memory was live at the peak.
+        // Checkpoints lose the live bytes of the checkpoints of the same names.
+        void remove_baseline(const AllocationStats& base);
+        // Index of the most populated bucket, -1 if there were no allocations.
+        int top_bucket() const;
+        // E.g. "32-63 B".
+        static std::string bucket_name(int bucket);
+
+        void save(std::ostream& out) const;
+        bool load(std::istream& in);
+    };
+
+    // Tracking is enabled for the whole process, but only the calling thread is
+    // tracked between start and stop. With tracking disabled operator new does
+    // nothing but malloc() and a test of a flag. While tracking, every allocation and
+    // deallocation also does the bookkeeping, which is timed along with the tested code,
+    // under --memory as well as under --allocations.
+    void enable_allocation_tracking();
+    void start_allocation_tracking();
+    AllocationStats stop_allocation_tracking();
+
+    // Records the bytes live on the calling thread since the start of tracking, the size of the
+    // tested structure is given in elements. Testers call it after building the structure and
+    // before destroying it. Does nothing unless allocations are tracked.
+    void memory_checkpoint(const std::string& name, long long elements);
+};
+
+#endif // SPEEDTEST_ALLOC_TRACKER_H_
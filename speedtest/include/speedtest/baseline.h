@@ -0,0 +1,67 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_BASELINE_H_
+#define SPEEDTEST_BASELINE_H_
+
+#include <speedtest/statistics.h>
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <tuple>
+
+namespace speedtest {
+    // A measured value of the current run compared to the same value in the baseline.
+    // Unknown values are negative.
+    struct Comparison {
+        // Median of the baseline over the median of the current run, less than 1 is slower.
+        double speedup = -1;
+        double p_value = -1;
+
+        bool valid() const {
+            return speedup >= 0;
+        }
+        // Significantly slower by more than threshold, a fraction of the baseline time.
+        bool regressed(double threshold) const {
+            return valid() && speedup * (1 + threshold) < 1 && p_value < significance_level;
+        }
+    };
+
+    // Samples of a previous run, as written by the CSV output method.
+    class Baseline {
+    public:
+        bool load(const std::string& path);
+
+        // Param is empty for tests other than multiparam ones.
+        Comparison compare(const std::string& solution, const std::string& test, const std::string& param,
+                           const Samples& samples) const;
+
+        // The least number of samples of a cell, zero if there are none.
+        std::size_t min_samples() const;
+    private:
+        std::map<std::tuple<std::string, std::string, std::string>, Samples> cells_;
+    };
+};
+
+#endif // SPEEDTEST_BASELINE_H_
@@ -0,0 +1,84 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_CLOCK_H_
+#define SPEEDTEST_CLOCK_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SPEEDTEST_HAS_TSC 1
+#endif
+
+namespace speedtest {
+    // Timestamp source used by MULTIPARAMTEST_INVOKE. Chrono ticks are nanoseconds of
+    // high_resolution_clock, TSC ticks are converted using a calibrated frequency.
+    enum class ClockBackend { Chrono, TSC };
+
+    extern ClockBackend clock_backend;
+    extern double ns_per_tick;
+
+    // Invariant TSC runs at a constant rate regardless of frequency scaling and sleep states.
+    bool invariant_tsc_available();
+    // Selects the backend, calibrating the TSC against steady_clock. Returns false
+    // if the TSC is requested but unusable, the chrono backend is selected then.
+    bool select_clock(ClockBackend backend);
+    std::string clock_name();
+
+    // The start timestamp is taken after all the preceding instructions have completed.
+    inline std::uint64_t clock_start() {
+#ifdef SPEEDTEST_HAS_TSC
+        if (clock_backend == ClockBackend::TSC) {
+            _mm_lfence();
+            std::uint64_t ret = __rdtsc();
+            _mm_lfence();
+            return ret;
+        }
+#endif
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+    }
+
+    // rdtscp waits for the measured instructions to complete.
+    inline std::uint64_t clock_stop() {
+#ifdef SPEEDTEST_HAS_TSC
+        if (clock_backend == ClockBackend::TSC) {
+            unsigned aux;
+            std::uint64_t ret = __rdtscp(&aux);
+            _mm_lfence();
+            return ret;
+        }
+#endif
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+    }
+
+    inline std::chrono::nanoseconds ticks_to_ns(std::uint64_t ticks) {
+        return std::chrono::nanoseconds((long long)(ticks * ns_per_tick));
+    }
+};
+
+#endif // SPEEDTEST_CLOCK_H_
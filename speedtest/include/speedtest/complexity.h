@@ -0,0 +1,80 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_COMPLEXITY_H_
+#define SPEEDTEST_COMPLEXITY_H_
+
+#include <string>
+#include <vector>
+
+namespace speedtest {
+    // The complexity class that describes the measured times best, time ~ constant * model(n).
+    struct ComplexityFit {
+        bool valid = false;
+        // E.g. "n log^2 n".
+        std::string model;
+        // In seconds.
+        double constant = 0;
+        // Slope of the log-log regression, time ~ n^exponent.
+        double exponent = 0;
+        // Root mean square of the relative error of the model, in log space.
+        double error = 0;
+    };
+
+    // Sizes min_n, min_n * factor, min_n * factor^2, ... up to max_n, rounded and without repetitions.
+    std::vector<long long> geometric_sizes(long long min_n, long long max_n, double factor);
+
+    // Needs at least two distinct sizes with positive times.
+    ComplexityFit fit_complexity(const std::vector<double>& sizes, const std::vector<double>& seconds);
+
+    // Sizes at which the faster of the two solutions changes, interpolated in log-log space.
+    std::vector<double> crossovers(const std::vector<double>& sizes, const std::vector<double>& a,
+                                   const std::vector<double>& b);
+
+    // Times of every solution on a tester over a range of sizes.
+    struct SweepReport {
+        struct Row {
+            std::string solution_name;
+            // False if the solution failed on some size, the times and the fit are meaningless then.
+            bool exec_result;
+            std::vector<double> seconds;
+            ComplexityFit fit;
+        };
+        struct Crossover {
+            // The solution which is faster below the size.
+            std::string faster_below;
+            std::string faster_above;
+            double size;
+        };
+
+        std::string test_name;
+        std::vector<long long> sizes;
+        std::vector<Row> rows;
+        std::vector<Crossover> crossovers;
+
+        // Fits the rows and finds the crossovers between every two of them.
+        void analyze();
+    };
+};
+
+#endif // SPEEDTEST_COMPLEXITY_H_
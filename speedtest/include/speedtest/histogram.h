@@ -0,0 +1,81 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_HISTOGRAM_H_
+#define SPEEDTEST_HISTOGRAM_H_
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace speedtest {
+    // HDR-style histogram of latencies in nanoseconds. Values below 2^(sub_bits + 1)
+    // are stored exactly, larger ones are bucketed with 2^sub_bits buckets per power
+    // of two, so the relative error is below 2^-sub_bits. Memory is fixed.
+    class LatencyHistogram {
+    public:
+        static const int sub_bits = 5;
+        static const int sub_buckets = 1 << sub_bits;
+        static const int num_buckets = (64 - sub_bits + 1) * sub_buckets;
+
+        LatencyHistogram();
+
+        void record(std::uint64_t value) {
+            counts_[bucket_index(value)]++;
+            total_++;
+            if (value > max_)
+                max_ = value;
+        }
+
+        void add(const LatencyHistogram& other);
+
+        std::uint64_t total() const { return total_; }
+        std::uint64_t max() const { return max_; }
+        // The highest value equivalent to the q-th quantile, 0 <= q <= 1.
+        std::uint64_t quantile(double q) const;
+
+        void save(std::ostream& out) const;
+        bool load(std::istream& in);
+
+        static int bucket_index(std::uint64_t value) {
+            if (value < 2 * sub_buckets)
+                return (int)value;
+            int shift = msb(value) - sub_bits;
+            return shift * sub_buckets + (int)(value >> shift);
+        }
+    private:
+        static int msb(std::uint64_t value) {
+            return 63 - __builtin_clzll(value);
+        }
+        static std::uint64_t highest_equivalent(int index);
+
+        std::vector<std::uint64_t> counts_;
+        std::uint64_t total_;
+        std::uint64_t max_;
+    };
+
+    // Quantiles shown in the outputs.
+    const std::vector<double> reported_quantiles = { 0.5, 0.9, 0.99, 0.999 };
+};
+
+#endif // SPEEDTEST_HISTOGRAM_H_
@@ -0,0 +1,56 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_ISOLATION_H_
+#define SPEEDTEST_ISOLATION_H_
+
+#include <functional>
+#include <memory>
+
+namespace speedtest {
+    struct BasicTestResult;
+
+    // Resources consumed by a child process that ran a single tester on a single solution.
+    struct ResourceUsage {
+        bool valid = false;
+        // Peak resident set size of the process, in kilobytes. For a child of
+        // run_isolated, the growth over the pages it shared with the parent at fork.
+        long max_rss = 0;
+        long minor_faults = 0;
+        long major_faults = 0;
+        long voluntary_switches = 0;
+        long involuntary_switches = 0;
+
+        // Usage of the calling process since its start.
+        static ResourceUsage current();
+        // Faults, context switches and the growth of the peak RSS since the earlier usage.
+        ResourceUsage since(const ResourceUsage& earlier) const;
+    };
+
+    // Forks a child process which calls body() and sends the result back over a pipe.
+    // If the child dies, the result is loaded into failed with the crashed flag set.
+    std::shared_ptr<BasicTestResult> run_isolated(std::shared_ptr<BasicTestResult> failed,
+                                                  const std::function<std::shared_ptr<BasicTestResult>()>& body);
+};
+
+#endif // SPEEDTEST_ISOLATION_H_
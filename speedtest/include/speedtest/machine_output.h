@@ -0,0 +1,101 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_MACHINE_OUTPUT_H_
+#define SPEEDTEST_MACHINE_OUTPUT_H_
+
+#include <speedtest/speedtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace speedtest {
+    // A single JSON document with the environment, the tests and every result
+    // including the raw samples.
+    class JSONStatOutputMethod : public StatOutputMethod {
+    public:
+        JSONStatOutputMethod() {}
+        virtual ~JSONStatOutputMethod() {}
+
+        virtual void add_test(std::string test_name);
+        virtual void add_multiparam_test(std::string test_name, std::vector<std::string> params);
+        virtual void add_multitest(std::string test_name, int test_num);
+        virtual void print(std::string solution_name, std::deque<TestResultPtr> tr);
+        virtual void flush();
+        virtual void print_multitest_result(MultitestResult result);
+        virtual void print_multiparam_test_result(MultiparamTestResult result);
+        virtual void print_single_test_result(SingleTestResult result);
+        virtual void print_sweep(const SweepReport& report);
+    private:
+        struct TestInfo {
+            std::string name;
+            std::string type;
+            std::vector<std::string> params;
+            int num_tests;
+        };
+
+        void begin_result(const BasicTestResult& result);
+        void end_result(const BasicTestResult& result);
+        void print_value(const BasicTestResult& result, const std::string& param, std::chrono::nanoseconds exec_time,
+                         const Samples& samples, const CounterValues& counters, long long ops,
+                         const LatencyHistogram* histogram);
+
+        std::vector<TestInfo> tests_;
+        std::string solution_name_;
+        std::ostringstream results_;
+        bool first_result_ = true;
+        std::ostringstream sweeps_;
+    };
+
+    // One row per sample: solution, test, parameter, status, trial and time in
+    // nanoseconds. The environment is written as leading comment lines.
+    class CSVStatOutputMethod : public StatOutputMethod {
+    public:
+        CSVStatOutputMethod() {}
+        virtual ~CSVStatOutputMethod() {}
+
+        virtual void add_test(std::string) {}
+        virtual void add_multiparam_test(std::string test_name, std::vector<std::string> params);
+        virtual void add_multitest(std::string, int) {}
+        virtual void print(std::string solution_name, std::deque<TestResultPtr> tr);
+        virtual void flush();
+        virtual void print_multitest_result(MultitestResult result);
+        virtual void print_multiparam_test_result(MultiparamTestResult result);
+        virtual void print_single_test_result(SingleTestResult result);
+        virtual void print_sweep(const SweepReport& report);
+
+        static const std::vector<std::string> columns;
+    private:
+        void print_samples(const BasicTestResult& result, const std::string& param, const Samples& samples);
+
+        std::map<std::string, std::vector<std::string> > param_map_;
+        std::string solution_name_;
+        std::ostringstream rows_;
+    };
+
+    // Status of a result as written by the machine-readable output methods.
+    std::string result_status(const BasicTestResult& result);
+};
+
+#endif // SPEEDTEST_MACHINE_OUTPUT_H_
@@ -0,0 +1,82 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_PARAMS_H_
+#define SPEEDTEST_PARAMS_H_
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace speedtest {
+    constexpr bool str_equal(const char* a, const char* b) {
+        while (*a != '\0' && *a == *b) {
+            a++;
+            b++;
+        }
+        return *a == *b;
+    }
+
+    // Compile-time list of multiparam test parameters. Multiparam testers declare it as
+    //     static constexpr speedtest::ParamList<2> params() { return {{ "insert", "erase" }}; }
+    // and MULTIPARAMTEST_INVOKE resolves parameter names to indices in it at compile time.
+    template<std::size_t N>
+    struct ParamList {
+        const char* names[N];
+
+        constexpr std::size_t size() const {
+            return N;
+        }
+
+        // N if there is no such parameter.
+        constexpr std::size_t index_of(const char* name) const {
+            for (std::size_t i = 0; i < N; i++) {
+                if (str_equal(names[i], name))
+                    return i;
+            }
+            return N;
+        }
+
+        std::vector<std::string> to_vector() const {
+            return std::vector<std::string>(names, names + N);
+        }
+    };
+
+    template<class Tester>
+    constexpr std::size_t param_index(const char* param) {
+        return std::remove_cv<typename std::remove_reference<Tester>::type>::type::params().index_of(param);
+    }
+
+    template<class Tester>
+    constexpr std::size_t param_count() {
+        return std::remove_cv<typename std::remove_reference<Tester>::type>::type::params().size();
+    }
+
+    template<class Tester>
+    std::vector<std::string> tested_params() {
+        return Tester::params().to_vector();
+    }
+};
+
+#endif // SPEEDTEST_PARAMS_H_
@@ -0,0 +1,74 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_PERF_COUNTERS_H_
+#define SPEEDTEST_PERF_COUNTERS_H_
+
+#include <cstdint>
+#include <string>
+
+namespace speedtest {
+    // Values of the hardware event counters. A counter is invalid if the
+    // kernel or the CPU does not support it.
+    struct CounterValues {
+        enum Event { Cycles, Instructions, L1dMisses, LLCMisses, BranchMisses, DTLBMisses, NumEvents };
+
+        double value[NumEvents] = {};
+        bool valid[NumEvents] = {};
+
+        static std::string event_name(int event);
+
+        CounterValues& operator+=(const CounterValues& other);
+        CounterValues operator-(const CounterValues& other) const;
+        // Subtracts the baseline counters measured over base_ops operations
+        // scaled to ops operations.
+        void remove_baseline(const CounterValues& base, long long base_ops, long long ops);
+
+        bool any_valid() const;
+        // Instructions per cycle, negative if unknown.
+        double ipc() const;
+        // Events per operation, negative if unknown.
+        double per_op(int event, long long ops) const;
+    };
+
+    // Counters of the calling thread, opened with perf_event_open(2). The
+    // counters are never stopped, CounterValues are computed as differences
+    // between two reads.
+    class PerfCounters {
+    public:
+        PerfCounters();
+        PerfCounters(const PerfCounters&) = delete;
+        ~PerfCounters();
+
+        static PerfCounters& thread_instance();
+
+        bool available() const;
+        CounterValues read() const;
+    private:
+        int leader_;
+        int fd_[CounterValues::NumEvents];
+        std::uint64_t id_[CounterValues::NumEvents];
+    };
+};
+
+#endif // SPEEDTEST_PERF_COUNTERS_H_
@@ -27,17 +27,49 @@
 #include <speedtest/speedtest.h>
 
 namespace speedtest {
-    extern std::shared_ptr<MultiparamTestResult> currentMultiparamInvocation;
+    extern thread_local std::shared_ptr<MultiparamTestResult> currentMultiparamInvocation;
+
+    // Measures a single invocation of a tested parameter: from the construction
+    // to the destruction. Counters are read outside of the timed region.
+    class ParamInvocation {
+    public:
+        ParamInvocation(MultiparamTestResult& res, std::size_t slot) : res_(res), slot_(slot) {
+            if (st_config.perf_counters)
+                counters_ = PerfCounters::thread_instance().read();
+            start_ = clock_start();
+        }
+
+        ~ParamInvocation() {
+            std::uint64_t elapsed = clock_stop() - start_;
+            MultiparamTestResult::ParamSlot& slot = res_.slots[slot_];
+            slot.ticks += elapsed;
+            slot.invocations++;
+            if (st_config.histograms)
+                res_.slot_histograms[slot_].record(ticks_to_ns(elapsed).count());
+            if (st_config.perf_counters)
+                slot.counters += PerfCounters::thread_instance().read() - counters_;
+        }
+    private:
+        MultiparamTestResult& res_;
+        std::size_t slot_;
+        CounterValues counters_;
+        std::uint64_t start_;
+    };
 };
 
-#define MULTIPARAMTEST_INVOKE(param, cmd)                                    \
-    if (speedtest::currentMultiparamInvocation.get() != nullptr) {           \
-        auto t1 = std::chrono::high_resolution_clock::now();                 \
-        cmd                                                                  \
-        auto t2 = std::chrono::high_resolution_clock::now();                 \
-        speedtest::currentMultiparamInvocation->exec_time[param] += t2 - t1; \
-    } else {                                                                 \
-        cmd                                                                  \
+// The slot of the parameter is its index in the params() of the enclosing tester,
+// resolved at compile time. Must be used inside a member function of the tester.
+#define MULTIPARAMTEST_INVOKE(param, cmd)                                                   \
+    if (speedtest::currentMultiparamInvocation.get() != nullptr) {                          \
+        constexpr std::size_t speedtest_param_slot =                                        \
+            speedtest::param_index<decltype(*this)>(param);                                 \
+        static_assert(speedtest_param_slot < speedtest::param_count<decltype(*this)>(),     \
+                      "MULTIPARAMTEST_INVOKE: parameter is not listed in params()");        \
+        speedtest::ParamInvocation invocation(*speedtest::currentMultiparamInvocation,      \
+                                              speedtest_param_slot);                        \
+        cmd                                                                                 \
+    } else {                                                                                \
+        cmd                                                                                 \
     }
 
 #endif // SPEEDTEST_RUNTIME_H_
\ No newline at end of file
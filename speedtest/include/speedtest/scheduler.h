@@ -0,0 +1,63 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_SCHEDULER_H_
+#define SPEEDTEST_SCHEDULER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace speedtest {
+    struct BasicTestResult;
+
+    // Runs independent (tester, solution) cells. With a single job the cells are run
+    // in the calling thread in the order they were added. Otherwise they are
+    // dispatched to a pool of worker threads, each pinned to its own core.
+    class Scheduler {
+    public:
+        typedef std::function<std::shared_ptr<BasicTestResult>()> Task;
+
+        Scheduler(int jobs, bool reserve_siblings);
+
+        // The result of the task is stored to *slot, which must stay valid until run() returns.
+        void add(Task task, std::shared_ptr<BasicTestResult>* slot);
+        // Runs all the added tasks and waits for them to finish.
+        void run();
+
+        // Logical CPUs the workers are pinned to: one per physical core first,
+        // then their hyperthread siblings unless those are reserved.
+        static std::vector<int> worker_cpus(bool reserve_siblings);
+    private:
+        struct Entry {
+            Task task;
+            std::shared_ptr<BasicTestResult>* slot;
+        };
+
+        int jobs_;
+        bool reserve_siblings_;
+        std::vector<Entry> tasks_;
+    };
+};
+
+#endif // SPEEDTEST_SCHEDULER_H_
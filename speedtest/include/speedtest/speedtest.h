@@ -24,7 +24,10 @@
 #ifndef SPEEDTEST_H_
 #define SPEEDTEST_H_
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
 #include <utility>
 #include <memory>
 #include <chrono>
@@ -34,13 +37,54 @@
 #include <map>
 #include <vector>
 
+#include <speedtest/statistics.h>
+#include <speedtest/perf_counters.h>
+#include <speedtest/histogram.h>
+#include <speedtest/clock.h>
+#include <speedtest/params.h>
+#include <speedtest/isolation.h>
+#include <speedtest/scheduler.h>
+#include <speedtest/baseline.h>
+#include <speedtest/complexity.h>
+#include <speedtest/alloc_tracker.h>
+
 namespace speedtest {
     class StatOutputMethod;
 
+    // The same cell run on several threads at once, each with a private copy of the tester.
+    struct ContentionStats {
+        bool valid = false;
+        int threads = 0;
+        // Time of a trial on a single thread.
+        double single_seconds = 0;
+        // Mean time of a trial on one of the concurrent threads.
+        double thread_seconds = 0;
+        // Median time from the start of the concurrent trials to the end of the last one.
+        double wall_seconds = 0;
+        long long ops_per_trial = 0;
+
+        // Operations per second done by all the threads together.
+        double throughput() const {
+            return wall_seconds > 0 ? threads * ops_per_trial / wall_seconds : -1;
+        }
+        // How many times a trial got slower when run on all the threads.
+        double slowdown() const {
+            return single_seconds > 0 ? thread_seconds / single_seconds : -1;
+        }
+    };
+
     struct BasicTestResult {
         std::string solution_name;
         std::string test_name;
         bool exec_result;
+        // The solution was run in a child process which died.
+        bool crashed = false;
+        // Only collected when the solution is run in a child process.
+        ResourceUsage usage;
+        // Allocations of a single trial, only collected in the allocation tracking mode.
+        AllocationStats allocations;
+        // Only collected in the contention mode.
+        ContentionStats contention;
         virtual void print_test(StatOutputMethod& statOutputMethod) = 0;
 
         // An accurate solution would be to use even more SFINAE there with no dynamic casts. For example, we could
@@ -48,44 +92,128 @@ namespace speedtest {
         // in TesterList for different tester types. But the code would be complicated enough and we can be sure that
         // dynamic casts wouldn't be broken here, so exactly this solution is used there.
         virtual void remove_empty_solution_difference(const std::shared_ptr<BasicTestResult> &d) = 0;
+
+        // Append the samples of another run of the same tester on the same solution.
+        virtual void add_trial(const BasicTestResult& trial) = 0;
+        virtual int num_trials() const = 0;
+        // The widest relative confidence interval among all measured values.
+        virtual double relative_ci_width() const = 0;
+        // Samples of every measured value by the parameter, which is empty unless
+        // the test is a multiparam one.
+        virtual std::map<std::string, Samples> measured_samples() const = 0;
+        // Operations done by a single trial: runs of the tester or invocations of the parameters.
+        virtual long long ops_per_trial() const = 0;
+
+        // Time of a trial, the sum of the medians of all measured values.
+        double trial_seconds() const;
+
+        // Serialization used to pass results from child processes.
+        virtual void save(std::ostream& out) const;
+        virtual bool load(std::istream& in);
     };
 
+    // exec_time is always the median of the samples, one sample per trial.
+    // Counters are summed over all the trials, ops is the number of trials.
     struct SingleTestResult : public BasicTestResult {
         std::chrono::nanoseconds exec_time;
+        Samples samples;
+        CounterValues counters;
+        long long ops = 1;
+
+        SingleTestResult() : exec_time(0) {
+            exec_result = false;
+        }
 
         SingleTestResult(bool result, std::chrono::nanoseconds time_elapsed) {
             exec_result = result;
             exec_time = time_elapsed;
+            samples.push_back(time_elapsed);
         }
 
         virtual void print_test(StatOutputMethod& stat_output);
         virtual void remove_empty_solution_difference(const std::shared_ptr<BasicTestResult> &d);
+        virtual void add_trial(const BasicTestResult& trial);
+        virtual int num_trials() const;
+        virtual double relative_ci_width() const;
+        virtual std::map<std::string, Samples> measured_samples() const;
+        virtual long long ops_per_trial() const;
+        virtual void save(std::ostream& out) const;
+        virtual bool load(std::istream& in);
     };
 
+    // A sample is the total time of all num_tests runs, an op is a single run.
     struct MultitestResult : public BasicTestResult {
         int test_num;
         std::chrono::nanoseconds exec_time;
+        Samples samples;
+        CounterValues counters;
+        long long ops;
+
+        MultitestResult(int num_tests) : exec_time(0) {
+            exec_result = false;
+            test_num = num_tests;
+            ops = 0;
+        }
 
         MultitestResult(bool result, std::chrono::nanoseconds time_elapsed, int num_tests) {
             exec_result = result;
             exec_time = time_elapsed;
             test_num = num_tests;
+            samples.push_back(time_elapsed);
+            ops = num_tests;
         }
 
         virtual void print_test(StatOutputMethod& stat_output);
         virtual void remove_empty_solution_difference(const std::shared_ptr<BasicTestResult> &d);
+        virtual void add_trial(const BasicTestResult& trial);
+        virtual int num_trials() const;
+        virtual double relative_ci_width() const;
+        virtual std::map<std::string, Samples> measured_samples() const;
+        virtual long long ops_per_trial() const;
+        virtual void save(std::ostream& out) const;
+        virtual bool load(std::istream& in);
     };
 
+    // Invocations of the current trial are accumulated in slots indexed by the position of the
+    // parameter in the tester's params(), so that MULTIPARAMTEST_INVOKE does no lookups.
+    // finish_trial() moves them to the maps.
+    // Counters are only collected in the performance counters mode, latency histograms
+    // of single invocations are only collected in the histogram mode.
     struct MultiparamTestResult : public BasicTestResult {
+        struct ParamSlot {
+            std::uint64_t ticks = 0;
+            long long invocations = 0;
+            CounterValues counters;
+        };
+        std::vector<ParamSlot> slots;
+        std::vector<LatencyHistogram> slot_histograms;
+
         std::map<std::string, std::chrono::nanoseconds> exec_time;
+        std::map<std::string, Samples> samples;
+        std::map<std::string, CounterValues> counters;
+        std::map<std::string, long long> invocations;
+        std::map<std::string, LatencyHistogram> histograms;
 
-        MultiparamTestResult() {}
+        MultiparamTestResult() {
+            exec_result = false;
+        }
+
+        void start_trial(const std::vector<std::string>& params);
+        void finish_trial(const std::vector<std::string>& params);
 
         virtual void print_test(StatOutputMethod& stat_output);
         virtual void remove_empty_solution_difference(const std::shared_ptr<BasicTestResult> &d);
+        virtual void add_trial(const BasicTestResult& trial);
+        virtual int num_trials() const;
+        virtual double relative_ci_width() const;
+        virtual std::map<std::string, Samples> measured_samples() const;
+        virtual long long ops_per_trial() const;
+        virtual void save(std::ostream& out) const;
+        virtual bool load(std::istream& in);
     };
 
-    extern std::shared_ptr<MultiparamTestResult> currentMultiparamInvocation;
+    // Every worker thread measures its own multiparam invocation.
+    extern thread_local std::shared_ptr<MultiparamTestResult> currentMultiparamInvocation;
 
     typedef std::shared_ptr<BasicTestResult> TestResultPtr;
 
@@ -102,6 +230,8 @@ namespace speedtest {
         virtual void print_multitest_result(MultitestResult result) = 0;
         virtual void print_multiparam_test_result(MultiparamTestResult result) = 0;
         virtual void print_single_test_result(SingleTestResult result) = 0;
+        // Called after all the rows are printed.
+        virtual void print_sweep(const SweepReport& report) = 0;
     };
 
     // Member check idiom
@@ -115,11 +245,20 @@ namespace speedtest {
         static constexpr bool value = sizeof(check<Tester>(nullptr)) == sizeof(char);
     };
 
-    // This is member check idiom, too
+    // This is member check idiom, too. Multiparam testers have a static params() function.
     template<class Tester>
     class IsMultiparamTest {
-        template<class U, std::vector<std::string> (U::*)() const> struct Check;
-        template<class U> static char check(Check<U, &U::tested_params> *);
+        template<class U> static char check(decltype(U::params().size()) *);
+        template<class U> static int check(...);
+    public:
+        static constexpr bool value = sizeof(check<Tester>(nullptr)) == sizeof(char);
+    };
+
+    // Sweeps (see sweep.h) are lists of testers rather than testers.
+    template<class Tester>
+    class IsSweep {
+        template<class U, const std::vector<long long>& (U::*)() const> struct Check;
+        template<class U> static char check(Check<U, &U::sweep_sizes> *);
         template<class U> static int check(...);
     public:
         static constexpr bool value = sizeof(check<Tester>(nullptr)) == sizeof(char);
@@ -131,6 +270,8 @@ namespace speedtest {
     using is_multiparam_test = std::integral_constant<bool, IsMultiparamTest<Tester>::value>;
     template<class Tester>
     using is_singletest = std::integral_constant<bool, !IsMultitest<Tester>::value && !IsMultiparamTest<Tester>::value>;
+    template<class Tester>
+    using is_sweep = std::integral_constant<bool, IsSweep<Tester>::value>;
 
     // Assuring that the test has the only single type
     template<class Tester>
@@ -141,23 +282,106 @@ namespace speedtest {
     };
 
     struct SpeedTestConfig {
-        enum class OutputMethod { ASCIITable, PlainText };
+        enum class OutputMethod { ASCIITable, PlainText, JSON, CSV };
+        // Hot trials run one after another, cold ones are preceded by flush_caches().
+        enum class CacheMode { Hot = 0, Cold = 1 };
         std::unique_ptr<StatOutputMethod> output;
         bool quiet = false;
         bool print_help = false;
         OutputMethod output_method = OutputMethod::ASCIITable;
+        // Write the results to this file instead of stdout if not empty.
+        std::string output_file;
+        // Minimal number of trials for every tester and solution.
+        int trials = 1;
+        // Adaptive mode: run more trials until the relative confidence interval
+        // width is below target_ci or max_trials is reached. Disabled if zero.
+        double target_ci = 0;
+        int max_trials = 100;
+        // A confidence interval over fewer samples says nothing.
+        static constexpr int min_adaptive_trials = 3;
+        // Discarded runs before the measured trials: at least warmup of them and
+        // at least warmup_time seconds.
+        int warmup = 0;
+        double warmup_time = 0;
+        std::vector<CacheMode> cache_modes = { CacheMode::Hot };
+        // Size of the buffer streamed through by flush_caches(), zero means
+        // twice the size of the last level cache.
+        std::size_t flush_size = 0;
+        // Collect hardware performance counters around timed regions.
+        bool perf_counters = false;
+        ClockBackend clock = ClockBackend::Chrono;
+        // Measure the instrumentation overhead, report it and exit.
+        bool self_test = false;
+        // Record a latency histogram of every MULTIPARAMTEST_INVOKE parameter.
+        bool histograms = false;
+        // Run every tester on every solution in a separate child process.
+        bool isolate = false;
+        // Number of worker threads running cells concurrently, zero means one per physical core.
+        int jobs = 1;
+        // Never put two workers on hyperthreads of the same physical core.
+        bool reserve_siblings = false;
+        // Contention mode: also run every cell on this many threads at once if more than one.
+        int threads = 1;
+        // Record heap allocations made in timed regions.
+        bool track_allocations = false;
+        // Report the peak heap footprint and the bytes per element at memory checkpoints.
+        bool memory = false;
+        // Print the row of the empty solution, whose times are subtracted from the others.
+        bool show_empty = false;
+        // Results of a previous run to compare with, null if there is none.
+        std::shared_ptr<Baseline> baseline;
+        // A value slower than in the baseline by more than this fraction is a regression.
+        double regress_threshold = 0.05;
+        // Number of significant regressions found by check_regressions().
+        int regressions = 0;
+
+        // Test name as shown in the output for the given cache mode.
+        std::string test_name(const std::string& name, CacheMode mode) const {
+            if (mode == CacheMode::Cold)
+                return name + " (cold)";
+            if (cache_modes.size() > 1)
+                return name + " (hot)";
+            return name;
+        }
+
+        bool collect_stats() const {
+            return trials > 1 || target_ci > 0;
+        }
+        Comparison compare_to_baseline(const BasicTestResult& r, const std::string& param,
+                                       const Samples& samples) const {
+            if (baseline.get() == nullptr)
+                return Comparison();
+            return baseline->compare(r.solution_name, r.test_name, param, samples);
+        }
+        bool need_more_trials(const BasicTestResult& r) const {
+            if (r.num_trials() < trials)
+                return true;
+            if (target_ci <= 0 || r.num_trials() >= max_trials)
+                return false;
+            return r.num_trials() < min_adaptive_trials || r.relative_ci_width() > target_ci;
+        }
+        template<class Tester>
+        void add_test(const Tester& t) {
+            add_test(t, t.name());
+        }
         // stackoverflow hacks
         template<class Tester>
-        typename std::enable_if<is_multitest<Tester>::value, void>::type add_test(const Tester& t) {
-            output->add_multitest(t.name(), t.num_tests());
+        typename std::enable_if<is_multitest<Tester>::value, void>::type add_test(const Tester& t,
+                                                                                   const std::string& name) {
+            for (CacheMode mode : cache_modes)
+                output->add_multitest(test_name(name, mode), t.num_tests());
         }
         template<class Tester>
-        typename std::enable_if<is_multiparam_test<Tester>::value, void>::type add_test(const Tester& t) {
-            output->add_multiparam_test(t.name(), t.tested_params());
+        typename std::enable_if<is_multiparam_test<Tester>::value, void>::type add_test(const Tester&,
+                                                                                         const std::string& name) {
+            for (CacheMode mode : cache_modes)
+                output->add_multiparam_test(test_name(name, mode), tested_params<Tester>());
         }
         template<class Tester>
-        typename std::enable_if<is_singletest<Tester>::value, void>::type add_test(const Tester& t) {
-            output->add_test(t.name());
+        typename std::enable_if<is_singletest<Tester>::value, void>::type add_test(const Tester&,
+                                                                                    const std::string& name) {
+            for (CacheMode mode : cache_modes)
+                output->add_test(test_name(name, mode));
         }
         template<class Tester>
         static typename std::enable_if<is_multitest<Tester>::value, int>::type get_num_tests(const Tester& t) {
@@ -171,24 +395,51 @@ namespace speedtest {
     
     extern SpeedTestConfig st_config;
 
+    // Writes a line to stderr, lines from different threads are not mixed up.
+    void log_message(const std::string& message);
+
+    // Whether the solution or the test is selected by --solution and --test.
+    bool solution_selected(const std::string& name);
+    bool test_selected(const std::string& name);
+
+    // Evicts the data caches by streaming through a buffer larger than the last level cache.
+    void flush_caches();
+
+    inline CounterValues read_counters() {
+        if (!st_config.perf_counters)
+            return CounterValues();
+        return PerfCounters::thread_instance().read();
+    }
+
     template<class Tester, class Solution>
     typename std::enable_if<is_multitest<Tester>::value, TestResultPtr>::type inner_run(Tester& t) {
         bool ret = true;
         int rep = t.num_tests();
 
+        start_allocation_tracking();
+        CounterValues c1 = read_counters();
         auto t1 = std::chrono::high_resolution_clock::now();
         for (int i = 0; i < rep; i++) {
             ret = ret & t.template test<Solution>();
         }
         auto t2 = std::chrono::high_resolution_clock::now();
+        CounterValues c2 = read_counters();
+        AllocationStats allocations = stop_allocation_tracking();
 
-        return std::make_shared<MultitestResult>(ret, t2 - t1, rep);
+        auto res = std::make_shared<MultitestResult>(ret, t2 - t1, rep);
+        res->counters = c2 - c1;
+        res->allocations = allocations;
+        return res;
     }
 
     template<class Tester, class Solution>
     typename std::enable_if<is_multiparam_test<Tester>::value, TestResultPtr>::type inner_run(Tester& t) {
         currentMultiparamInvocation = std::make_shared<MultiparamTestResult>();
+        currentMultiparamInvocation->start_trial(tested_params<Tester>());
+        start_allocation_tracking();
         currentMultiparamInvocation->exec_result = t.template test<Solution>();
+        currentMultiparamInvocation->allocations = stop_allocation_tracking();
+        currentMultiparamInvocation->finish_trial(tested_params<Tester>());
         auto ret = currentMultiparamInvocation;
         currentMultiparamInvocation = nullptr;
         return ret;
@@ -196,31 +447,269 @@ namespace speedtest {
 
     template<class Tester, class Solution>
     typename std::enable_if<is_singletest<Tester>::value, TestResultPtr>::type inner_run(Tester& t) {
+        start_allocation_tracking();
+        CounterValues c1 = read_counters();
         auto t1 = std::chrono::high_resolution_clock::now();
         bool result = t.template test<Solution>();
         auto t2 = std::chrono::high_resolution_clock::now();
+        CounterValues c2 = read_counters();
+        AllocationStats allocations = stop_allocation_tracking();
 
-        return std::make_shared<SingleTestResult>(result, t2 - t1);
+        auto res = std::make_shared<SingleTestResult>(result, t2 - t1);
+        res->counters = c2 - c1;
+        res->allocations = allocations;
+        return res;
     }
 
+    // Every trial is run on a fresh copy of the tester, so all the trials do the same work.
     template<class Tester, class Solution>
-    TestResultPtr run(const Tester& t) {
+    TestResultPtr run_trial(const Tester& t) {
         Tester tester_copy = t;
+        return inner_run<Tester, Solution>(tester_copy);
+    }
+
+    // Runs discarded trials, so that the measured ones do not pay for page faults on
+    // first allocations and for cold instruction caches.
+    template<class Tester, class Solution>
+    void warm_up(const Tester& t) {
+        auto start = std::chrono::steady_clock::now();
+        std::chrono::duration<double> budget(st_config.warmup_time);
+        for (int i = 0; i < st_config.warmup || std::chrono::steady_clock::now() - start < budget; i++)
+            run_trial<Tester, Solution>(t);
+    }
+
+    // An empty result of the tester's type, reported if the solution crashes.
+    template<class Tester>
+    typename std::enable_if<is_multitest<Tester>::value, TestResultPtr>::type make_result(const Tester& t) {
+        return std::make_shared<MultitestResult>(t.num_tests());
+    }
+
+    template<class Tester>
+    typename std::enable_if<is_multiparam_test<Tester>::value, TestResultPtr>::type make_result(const Tester& t) {
+        auto ret = std::make_shared<MultiparamTestResult>();
+        for (auto& param : tested_params<Tester>())
+            ret->samples[param];
+        return ret;
+    }
+
+    template<class Tester>
+    typename std::enable_if<is_singletest<Tester>::value, TestResultPtr>::type make_result(const Tester&) {
+        return std::make_shared<SingleTestResult>();
+    }
+
+    // Runs as many rounds as single-threaded trials were run, every round runs st_config.threads
+    // trials at once. The threads wait for each other before starting their trials.
+    template<class Tester, class Solution>
+    ContentionStats measure_contention(const Tester& t, bool cold, const BasicTestResult& single) {
+        ContentionStats ret;
+        ret.valid = true;
+        ret.threads = st_config.threads;
+        ret.single_seconds = single.trial_seconds();
+        ret.ops_per_trial = single.ops_per_trial();
+
+        std::vector<double> walls;
+        double thread_sum = 0;
+        for (int round = 0; round < single.num_trials(); round++) {
+            if (cold)
+                flush_caches();
+            std::vector<TestResultPtr> results(ret.threads);
+            std::atomic<int> ready(0);
+            std::atomic<bool> go(false);
+            std::vector<std::thread> threads;
+            for (int i = 0; i < ret.threads; i++) {
+                threads.emplace_back([&t, &results, &ready, &go, i]() {
+                    Tester tester_copy = t;
+                    ready++;
+                    while (!go)
+                        std::this_thread::yield();
+                    results[i] = inner_run<Tester, Solution>(tester_copy);
+                });
+            }
+            while (ready < ret.threads)
+                std::this_thread::yield();
+            auto start = std::chrono::steady_clock::now();
+            go = true;
+            for (auto& thread : threads)
+                thread.join();
+            auto finish = std::chrono::steady_clock::now();
+            walls.push_back(std::chrono::duration<double>(finish - start).count());
+            for (auto& res : results)
+                thread_sum += res->trial_seconds();
+        }
+        std::sort(walls.begin(), walls.end());
+        ret.wall_seconds = walls[walls.size() / 2];
+        ret.thread_seconds = thread_sum / (walls.size() * ret.threads);
+        return ret;
+    }
+
+    template<class Tester, class Solution>
+    TestResultPtr measure(const Tester& t, SpeedTestConfig::CacheMode mode) {
+        warm_up<Tester, Solution>(t);
+        bool cold = mode == SpeedTestConfig::CacheMode::Cold;
+        if (cold)
+            flush_caches();
+        TestResultPtr ret = run_trial<Tester, Solution>(t);
+        while (st_config.need_more_trials(*ret)) {
+            if (cold)
+                flush_caches();
+            ret->add_trial(*run_trial<Tester, Solution>(t));
+        }
+        if (st_config.threads > 1)
+            ret->contention = measure_contention<Tester, Solution>(t, cold, *ret);
+        return ret;
+    }
+
+    // The tester is shown under the given name, which is its name() unless it is a part of a sweep.
+    template<class Tester, class Solution>
+    TestResultPtr run(const Tester& t, const std::string& name,
+                      SpeedTestConfig::CacheMode mode = SpeedTestConfig::CacheMode::Hot) {
         TestAssertion<Tester> testAssertion;
+        std::string test_name = st_config.test_name(name, mode);
 
         if (!st_config.quiet)
-            std::cerr << "Running solution " << Solution::name() << " on test " << tester_copy.name() << std::endl;
-        TestResultPtr ret = inner_run<Tester, Solution>(tester_copy);
+            log_message("Running solution " + Solution::name() + " on test " + test_name);
+        TestResultPtr ret;
+        if (st_config.isolate)
+            ret = run_isolated(make_result(t), [&t, mode]() { return measure<Tester, Solution>(t, mode); });
+        else
+            ret = measure<Tester, Solution>(t, mode);
 
         ret->solution_name = Solution::name();
-        ret->test_name = tester_copy.name();
+        ret->test_name = test_name;
 
-        if (!ret->exec_result)
-            std::cerr << "Warning: solution " << Solution::name() << " failed on test " << tester_copy.name() << std::endl;
+        if (ret->crashed)
+            log_message("Warning: solution " + Solution::name() + " crashed on test " + test_name);
+        else if (!ret->exec_result)
+            log_message("Warning: solution " + Solution::name() + " failed on test " + test_name);
         
         return ret;
     }
+
+    template<class Tester, class Solution>
+    TestResultPtr run(const Tester& t, SpeedTestConfig::CacheMode mode = SpeedTestConfig::CacheMode::Hot) {
+        return run<Tester, Solution>(t, t.name(), mode);
+    }
     
+    // Schedules a run of the tester on the solution in all the cache modes. Results are appended to ret,
+    // the empty solution results must be known by the time the scheduled task is started.
+    template<class Tester, class Solution>
+    void schedule_run(Scheduler& scheduler, const Tester& t, const std::string& name,
+                      const TestResultPtr* empty_results, std::deque<TestResultPtr>& ret) {
+        for (auto mode : st_config.cache_modes) {
+            ret.push_back(nullptr);
+            const TestResultPtr* empty = &empty_results[(int)mode];
+            scheduler.add([&t, name, mode, empty]() {
+                TestResultPtr res = speedtest::run<Tester, Solution>(t, name, mode);
+                res->remove_empty_solution_difference(*empty);
+                return res;
+            }, &ret.back());
+        }
+    }
+
+    template<class Tester, class EmptySolution>
+    void schedule_empty_run(Scheduler& scheduler, const Tester& t, const std::string& name,
+                            TestResultPtr* empty_results) {
+        for (auto mode : st_config.cache_modes) {
+            scheduler.add([&t, name, mode]() {
+                return speedtest::run<Tester, EmptySolution>(t, name, mode);
+            }, &empty_results[(int)mode]);
+        }
+    }
+
+    // TesterList entries are either testers or sweeps, which schedule their testers themselves.
+    template<class Tester, class Solution>
+    typename std::enable_if<!is_sweep<Tester>::value, void>::type
+    schedule_entry(Scheduler& scheduler, const Tester& t, const TestResultPtr* empty_results,
+                   std::deque<TestResultPtr>& ret) {
+        if (test_selected(t.name()))
+            schedule_run<Tester, Solution>(scheduler, t, t.name(), empty_results, ret);
+    }
+
+    template<class Tester, class Solution>
+    typename std::enable_if<is_sweep<Tester>::value, void>::type
+    schedule_entry(Scheduler& scheduler, const Tester& t, const TestResultPtr*, std::deque<TestResultPtr>& ret) {
+        if (test_selected(t.name()))
+            t.template schedule<Solution>(scheduler, ret);
+    }
+
+    template<class Tester, class EmptySolution>
+    typename std::enable_if<!is_sweep<Tester>::value, void>::type
+    schedule_empty_entry(Scheduler& scheduler, Tester& t, TestResultPtr* empty_results) {
+        if (test_selected(t.name()))
+            schedule_empty_run<Tester, EmptySolution>(scheduler, t, t.name(), empty_results);
+    }
+
+    template<class Tester, class EmptySolution>
+    typename std::enable_if<is_sweep<Tester>::value, void>::type
+    schedule_empty_entry(Scheduler& scheduler, Tester& t, TestResultPtr*) {
+        if (test_selected(t.name()))
+            t.template schedule_empty<EmptySolution>(scheduler);
+    }
+
+    // A tester may define prepare() to build its input once it is selected,
+    // before any cell runs and before --isolate forks.
+    template<class Tester>
+    auto prepare_entry(Tester& t, int) -> decltype(t.prepare(), void()) {
+        t.prepare();
+    }
+
+    template<class Tester>
+    void prepare_entry(Tester&, long) {}
+
+    template<class Tester>
+    typename std::enable_if<!is_sweep<Tester>::value, void>::type setup_entry(Tester& t) {
+        if (test_selected(t.name())) {
+            prepare_entry(t, 0);
+            st_config.add_test(t);
+        }
+    }
+
+    template<class Tester>
+    typename std::enable_if<is_sweep<Tester>::value, void>::type setup_entry(Tester& t) {
+        if (test_selected(t.name()))
+            t.setup();
+    }
+
+    template<class Tester>
+    typename std::enable_if<!is_sweep<Tester>::value, void>::type report_entry(const Tester&) {}
+
+    template<class Tester>
+    typename std::enable_if<is_sweep<Tester>::value, void>::type report_entry(const Tester& t) {
+        if (test_selected(t.name()))
+            t.report();
+    }
+
+    // Results of the empty solution on an entry in the order of the cells of a row.
+    template<class Tester>
+    typename std::enable_if<!is_sweep<Tester>::value, void>::type
+    empty_row_entry(const Tester& t, const TestResultPtr* empty_results, std::deque<TestResultPtr>& ret) {
+        if (test_selected(t.name())) {
+            for (auto mode : st_config.cache_modes)
+                ret.push_back(empty_results[(int)mode]);
+        }
+    }
+
+    template<class Tester>
+    typename std::enable_if<is_sweep<Tester>::value, void>::type
+    empty_row_entry(const Tester& t, const TestResultPtr*, std::deque<TestResultPtr>& ret) {
+        if (test_selected(t.name()))
+            t.empty_row(ret);
+    }
+
+    // Names of the tests of an entry, a sweep has one per size.
+    template<class Tester>
+    typename std::enable_if<!is_sweep<Tester>::value, void>::type
+    list_entry(const Tester& t, std::vector<std::string>& names) {
+        names.push_back(t.name());
+    }
+
+    template<class Tester>
+    typename std::enable_if<is_sweep<Tester>::value, void>::type
+    list_entry(const Tester& t, std::vector<std::string>& names) {
+        for (std::size_t i = 0; i != t.sweep_sizes().size(); i++)
+            names.push_back(t.tester_name(i));
+    }
+
     template<class T, class... Others>
     class TesterList {
     public:
@@ -228,28 +717,42 @@ namespace speedtest {
                                                  next_(others...) {}
 
         template<class Solution>
-        std::deque<TestResultPtr> run() const {
-            TestResultPtr head = speedtest::run<T, Solution>(val_);
-            head->remove_empty_solution_difference(emptySolutionResult);
-            std::deque<TestResultPtr> ret = next_.template run<Solution>();
-            ret.push_front(head);
-            return ret;
+        void schedule(Scheduler& scheduler, std::deque<TestResultPtr>& ret) const {
+            schedule_entry<T, Solution>(scheduler, val_, emptySolutionResult, ret);
+            next_.template schedule<Solution>(scheduler, ret);
         }
 
         void setup() {
-            st_config.add_test(val_);
+            setup_entry(val_);
             next_.setup();
         }
 
+        void report() const {
+            report_entry(val_);
+            next_.report();
+        }
+
+        void list(std::vector<std::string>& names) const {
+            if (test_selected(val_.name()))
+                list_entry(val_, names);
+            next_.list(names);
+        }
+
         template<class EmptySolution>
-        void run_empty() {
-            emptySolutionResult = speedtest::run<T, EmptySolution>(val_);
-            next_.template run_empty<EmptySolution>();
+        void schedule_empty(Scheduler& scheduler) {
+            schedule_empty_entry<T, EmptySolution>(scheduler, val_, emptySolutionResult);
+            next_.template schedule_empty<EmptySolution>(scheduler);
+        }
+
+        void empty_row(std::deque<TestResultPtr>& ret) const {
+            empty_row_entry(val_, emptySolutionResult, ret);
+            next_.empty_row(ret);
         }
         
     private:
         T val_;
-        TestResultPtr emptySolutionResult;
+        // Indexed by SpeedTestConfig::CacheMode.
+        TestResultPtr emptySolutionResult[2];
         TesterList<Others...> next_;
     };
 
@@ -259,24 +762,36 @@ namespace speedtest {
         TesterList(T tester) : val_(std::move(tester)) {}
 
         template<class Solution>
-        std::deque<TestResultPtr> run() const {
-            TestResultPtr ret = speedtest::run<T, Solution>(val_);
-            ret->remove_empty_solution_difference(emptySolutionResult);
-            return std::deque<TestResultPtr>({ret});
+        void schedule(Scheduler& scheduler, std::deque<TestResultPtr>& ret) const {
+            schedule_entry<T, Solution>(scheduler, val_, emptySolutionResult, ret);
         }
 
         void setup() {
-            st_config.add_test(val_);
+            setup_entry(val_);
+        }
+
+        void report() const {
+            report_entry(val_);
+        }
+
+        void list(std::vector<std::string>& names) const {
+            if (test_selected(val_.name()))
+                list_entry(val_, names);
         }
 
         template<class EmptySolution>
-        void run_empty() {
-            emptySolutionResult = speedtest::run<T, EmptySolution>(val_);
+        void schedule_empty(Scheduler& scheduler) {
+            schedule_empty_entry<T, EmptySolution>(scheduler, val_, emptySolutionResult);
+        }
+
+        void empty_row(std::deque<TestResultPtr>& ret) const {
+            empty_row_entry(val_, emptySolutionResult, ret);
         }
         
     private:
         T val_;
-        TestResultPtr emptySolutionResult = nullptr;
+        // Indexed by SpeedTestConfig::CacheMode.
+        TestResultPtr emptySolutionResult[2] = { nullptr, nullptr };
     };
 
     template<class... Types>
@@ -284,14 +799,39 @@ namespace speedtest {
         return TesterList<Types...>(args...);
     }
 
+    struct SolutionRow {
+        std::string solution_name;
+        std::deque<TestResultPtr> results;
+    };
+
     template<class Solution, class TesterList>
-    void process_solution(const TesterList& tl) {
-        if (!st_config.quiet)
-            std::cerr << "Processing solution " << Solution::name() << std::endl;
-        auto res = tl.template run<Solution>();
-        if (!st_config.quiet)
-            std::cerr << "Finished processing solution " << Solution::name() << std::endl;
-        st_config.output->print(Solution::name(), res);
+    void schedule_solution(const TesterList& tl, Scheduler& scheduler, std::deque<SolutionRow>& rows) {
+        if (!solution_selected(Solution::name()))
+            return;
+        rows.push_back(SolutionRow{ Solution::name(), {} });
+        tl.template schedule<Solution>(scheduler, rows.back().results);
+    }
+
+    // Compares the results with the baseline, reports and counts the regressions.
+    void check_regressions(const std::deque<TestResultPtr>& results);
+
+    inline Scheduler make_scheduler() {
+        return Scheduler(st_config.jobs, st_config.reserve_siblings);
+    }
+
+    // Runs every solution on every tester and prints the rows in the order of the solution list,
+    // then the sweep reports.
+    template<class SolutionList, class TesterList>
+    void run_solutions(const SolutionList& sl, const TesterList& tl) {
+        Scheduler scheduler = make_scheduler();
+        std::deque<SolutionRow> rows;
+        sl.schedule(tl, scheduler, rows);
+        scheduler.run();
+        for (auto& row : rows) {
+            check_regressions(row.results);
+            st_config.output->print(row.solution_name, row.results);
+        }
+        tl.report();
     }
 
     template<class T, class... Others>
@@ -301,8 +841,19 @@ namespace speedtest {
 
         template<class TesterList>
         void run(const TesterList& tl) const {
-            speedtest::process_solution<T, TesterList>(tl);
-            next_.run(tl);
+            run_solutions(*this, tl);
+        }
+
+        template<class TesterList>
+        void schedule(const TesterList& tl, Scheduler& scheduler, std::deque<SolutionRow>& rows) const {
+            speedtest::schedule_solution<T, TesterList>(tl, scheduler, rows);
+            next_.schedule(tl, scheduler, rows);
+        }
+
+        void list(std::vector<std::string>& names) const {
+            if (solution_selected(T::name()))
+                names.push_back(T::name());
+            next_.list(names);
         }
         
     private:
@@ -316,7 +867,17 @@ namespace speedtest {
 
         template<class TesterList>
         void run(const TesterList& tl) const {
-            speedtest::process_solution<T, TesterList>(tl);
+            run_solutions(*this, tl);
+        }
+
+        template<class TesterList>
+        void schedule(const TesterList& tl, Scheduler& scheduler, std::deque<SolutionRow>& rows) const {
+            speedtest::schedule_solution<T, TesterList>(tl, scheduler, rows);
+        }
+
+        void list(std::vector<std::string>& names) const {
+            if (solution_selected(T::name()))
+                names.push_back(T::name());
         }
     };
 
@@ -342,6 +903,8 @@ namespace speedtest {
 
         virtual void run() = 0;
         virtual void setup() = 0;
+        // Names of the selected solutions and tests.
+        virtual void list(std::vector<std::string>& solutions, std::vector<std::string>& tests) const = 0;
     };
 
     template<class StoredTesterList,
@@ -362,6 +925,11 @@ namespace speedtest {
         virtual void setup() {
             tester_list_.setup();
         }
+
+        virtual void list(std::vector<std::string>& solutions, std::vector<std::string>& tests) const {
+            solution_list_.list(solutions);
+            tester_list_.list(tests);
+        }
         
     private:
         StoredTesterList tester_list_;
@@ -378,12 +946,24 @@ namespace speedtest {
                                StoredSolutionList&& solution_list) : tester_list_(tester_list),
                                                                      solution_list_(solution_list) {}
         virtual void run() {
+            if (st_config.show_empty) {
+                std::deque<TestResultPtr> row;
+                tester_list_.empty_row(row);
+                st_config.output->print(EmptySolution::name(), row);
+            }
             solution_list_.run(tester_list_);
         }
 
         virtual void setup() {
             tester_list_.setup();
-            tester_list_.template run_empty<EmptySolution>();
+            Scheduler scheduler = make_scheduler();
+            tester_list_.template schedule_empty<EmptySolution>(scheduler);
+            scheduler.run();
+        }
+
+        virtual void list(std::vector<std::string>& solutions, std::vector<std::string>& tests) const {
+            solution_list_.list(solutions);
+            tester_list_.list(tests);
         }
 
     private:
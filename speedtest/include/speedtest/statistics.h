@@ -0,0 +1,68 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_STATISTICS_H_
+#define SPEEDTEST_STATISTICS_H_
+
+#include <chrono>
+#include <vector>
+
+namespace speedtest {
+    typedef std::vector<std::chrono::nanoseconds> Samples;
+
+    // Summary of a set of timing samples. All the values are in seconds.
+    struct SampleStats {
+        int count = 0;
+        double min = 0;
+        double median = 0;
+        double mean = 0;
+        double stddev = 0;
+        // Median absolute deviation from the median.
+        double mad = 0;
+        // Bootstrap confidence interval for the median.
+        double ci_low = 0;
+        double ci_high = 0;
+
+        // Width of the confidence interval relative to the median.
+        double relative_ci_width() const;
+    };
+
+    // Confidence level used for the bootstrap interval.
+    const double ci_level = 0.95;
+    // Number of bootstrap resamples.
+    const int bootstrap_resamples = 1000;
+    // Differences with a greater p-value are not considered significant.
+    const double significance_level = 0.05;
+    // With fewer samples on either side no p-value gets below significance_level.
+    const int min_significant_samples = 4;
+
+    std::chrono::nanoseconds median(Samples samples);
+    SampleStats compute_stats(const Samples& samples);
+
+    // Two-sided p-value of the Mann-Whitney U test that the samples come from the same
+    // distribution. Uses the normal approximation with tie and continuity corrections,
+    // so it needs a few samples on both sides to ever be significant.
+    double mann_whitney_p(const Samples& a, const Samples& b);
+};
+
+#endif // SPEEDTEST_STATISTICS_H_
@@ -0,0 +1,138 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPEEDTEST_SWEEP_H_
+#define SPEEDTEST_SWEEP_H_
+
+#include <speedtest/speedtest.h>
+
+#include <array>
+#include <deque>
+#include <sstream>
+#include <utility>
+
+namespace speedtest {
+    // A tester run over a geometric range of sizes. Every size is an ordinary test named
+    // "name n=size", and after all the rows the output gets a report with the complexity
+    // of every solution fitted to the times and the crossover points between the solutions.
+    // Factory makes a tester of the given size.
+    template<class Factory>
+    class Sweep {
+    public:
+        typedef decltype(std::declval<Factory>()(0LL)) Tester;
+
+        Sweep(std::string name, std::vector<long long> sizes, Factory factory)
+            : name_(std::move(name)),
+              sizes_(std::move(sizes)),
+              empty_results_(sizes_.size()) {
+            for (long long n : sizes_)
+                testers_.push_back(factory(n));
+        }
+
+        const std::vector<long long>& sweep_sizes() const {
+            return sizes_;
+        }
+
+        void setup() {
+            for (std::size_t i = 0; i != sizes_.size(); i++)
+                st_config.add_test(testers_[i], tester_name(i));
+        }
+
+        template<class Solution>
+        void schedule(Scheduler& scheduler, std::deque<TestResultPtr>& ret) const {
+            // Deque elements do not move when more are appended.
+            cells_.push_back(SolutionCells{ Solution::name(), {} });
+            for (std::size_t i = 0; i != sizes_.size(); i++) {
+                std::size_t first = ret.size();
+                schedule_run<Tester, Solution>(scheduler, testers_[i], tester_name(i),
+                                               empty_results_[i].data(), ret);
+                for (std::size_t j = first; j != ret.size(); j++)
+                    cells_.back().results.push_back(&ret[j]);
+            }
+        }
+
+        template<class EmptySolution>
+        void schedule_empty(Scheduler& scheduler) {
+            for (std::size_t i = 0; i != sizes_.size(); i++)
+                schedule_empty_run<Tester, EmptySolution>(scheduler, testers_[i], tester_name(i),
+                                                          empty_results_[i].data());
+        }
+
+        void empty_row(std::deque<TestResultPtr>& ret) const {
+            for (std::size_t i = 0; i != sizes_.size(); i++) {
+                for (auto mode : st_config.cache_modes)
+                    ret.push_back(empty_results_[i][(int)mode]);
+            }
+        }
+
+        // A report for every cache mode. The time of a multiparam test is the sum over the parameters.
+        void report() const {
+            std::size_t modes = st_config.cache_modes.size();
+            for (std::size_t m = 0; m != modes; m++) {
+                SweepReport report;
+                report.test_name = st_config.test_name(name_, st_config.cache_modes[m]);
+                report.sizes = sizes_;
+                for (auto& cells : cells_) {
+                    SweepReport::Row row{ cells.solution_name, true, {}, {} };
+                    for (std::size_t i = 0; i != sizes_.size(); i++) {
+                        const TestResultPtr& res = *cells.results[i * modes + m];
+                        row.exec_result = row.exec_result && res->exec_result;
+                        row.seconds.push_back(res->trial_seconds());
+                    }
+                    report.rows.push_back(row);
+                }
+                report.analyze();
+                st_config.output->print_sweep(report);
+            }
+        }
+        std::string name() const {
+            return name_;
+        }
+
+        std::string tester_name(std::size_t i) const {
+            std::ostringstream ss;
+            ss << name_ << " n=" << sizes_[i];
+            return ss.str();
+        }
+    private:
+        struct SolutionCells {
+            std::string solution_name;
+            // Indexed by size, then by cache mode.
+            std::vector<const TestResultPtr*> results;
+        };
+
+        std::string name_;
+        std::vector<long long> sizes_;
+        std::vector<Tester> testers_;
+        // Indexed by size, then by SpeedTestConfig::CacheMode.
+        std::vector<std::array<TestResultPtr, 2> > empty_results_;
+        mutable std::deque<SolutionCells> cells_;
+    };
+
+    template<class Factory>
+    Sweep<Factory> sweep(std::string name, long long min_n, long long max_n, double factor, Factory factory) {
+        return Sweep<Factory>(std::move(name), geometric_sizes(min_n, max_n, factor), std::move(factory));
+    }
+};
+
+#endif // SPEEDTEST_SWEEP_H_
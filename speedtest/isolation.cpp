@@ -0,0 +1,140 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/isolation.h>
+#include <speedtest/speedtest.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace speedtest {
+    ResourceUsage ResourceUsage::current() {
+        ResourceUsage ret;
+        rusage ru;
+        if (getrusage(RUSAGE_SELF, &ru) != 0)
+            return ret;
+        ret.valid = true;
+        ret.max_rss = ru.ru_maxrss;
+        ret.minor_faults = ru.ru_minflt;
+        ret.major_faults = ru.ru_majflt;
+        ret.voluntary_switches = ru.ru_nvcsw;
+        ret.involuntary_switches = ru.ru_nivcsw;
+        return ret;
+    }
+
+    ResourceUsage ResourceUsage::since(const ResourceUsage& earlier) const {
+        ResourceUsage ret = *this;
+        ret.valid = valid && earlier.valid;
+        ret.max_rss = std::max(0L, max_rss - earlier.max_rss);
+        ret.minor_faults -= earlier.minor_faults;
+        ret.major_faults -= earlier.major_faults;
+        ret.voluntary_switches -= earlier.voluntary_switches;
+        ret.involuntary_switches -= earlier.involuntary_switches;
+        return ret;
+    }
+
+    namespace {
+        bool write_all(int fd, const std::string& data) {
+            std::size_t done = 0;
+            while (done < data.size()) {
+                ssize_t written = write(fd, data.data() + done, data.size() - done);
+                if (written <= 0)
+                    return false;
+                done += written;
+            }
+            return true;
+        }
+
+        std::string read_all(int fd) {
+            std::string ret;
+            char buf[4096];
+            ssize_t got;
+            while ((got = read(fd, buf, sizeof(buf))) > 0)
+                ret.append(buf, got);
+            return ret;
+        }
+    };
+
+    std::shared_ptr<BasicTestResult> run_isolated(std::shared_ptr<BasicTestResult> failed,
+                                                  const std::function<std::shared_ptr<BasicTestResult>()>& body) {
+        // With -j the workers fork concurrently. A child forked while another
+        // worker held the write end of its pipe would keep that pipe open
+        // until it exits, so the pipe is created and the write end closed
+        // under a lock.
+        static std::mutex fork_mutex;
+        std::unique_lock<std::mutex> lock(fork_mutex);
+        int fds[2];
+        if (pipe(fds) != 0) {
+            std::cerr << "Error: pipe() failed: " << std::strerror(errno) << std::endl;
+            exit(1);
+        }
+        std::cout.flush();
+        std::cerr.flush();
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::cerr << "Error: fork() failed: " << std::strerror(errno) << std::endl;
+            exit(1);
+        }
+        if (pid == 0) {
+            // The child is single-threaded, the copy of the lock is never released.
+            close(fds[0]);
+            ResourceUsage start = ResourceUsage::current();
+            std::shared_ptr<BasicTestResult> res = body();
+            res->usage = ResourceUsage::current().since(start);
+            std::ostringstream out;
+            res->save(out);
+            // Destructors of the parent's objects must not run in the child.
+            _exit(write_all(fds[1], out.str()) ? 0 : 1);
+        }
+
+        close(fds[1]);
+        lock.unlock();
+        std::string data = read_all(fds[0]);
+        close(fds[0]);
+        int status;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+
+        std::istringstream in(data);
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && failed->load(in))
+            return failed;
+
+        failed->exec_result = false;
+        failed->crashed = true;
+        if (WIFSIGNALED(status))
+            log_message("Warning: child process was killed by signal " + std::to_string(WTERMSIG(status)));
+        else
+            log_message("Warning: child process exited abnormally");
+        return failed;
+    }
+};
@@ -0,0 +1,366 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/machine_output.h>
+#include <speedtest/environment.h>
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+namespace speedtest {
+    namespace {
+        std::string json_string(const std::string& str) {
+            std::ostringstream ss;
+            ss << '"';
+            for (char c : str) {
+                switch (c) {
+                case '"':
+                    ss << "\\\"";
+                    break;
+                case '\\':
+                    ss << "\\\\";
+                    break;
+                case '\n':
+                    ss << "\\n";
+                    break;
+                case '\t':
+                    ss << "\\t";
+                    break;
+                default:
+                    if ((unsigned char)c < 0x20) {
+                        char buf[8];
+                        std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+                        ss << buf;
+                    } else {
+                        ss << c;
+                    }
+                }
+            }
+            ss << '"';
+            return ss.str();
+        }
+
+        // Negative values mean that the value is unknown.
+        std::string json_number(double value) {
+            if (value < 0 || std::isnan(value) || std::isinf(value))
+                return "null";
+            std::ostringstream ss;
+            ss.precision(17);
+            ss << value;
+            return ss.str();
+        }
+
+        std::string json_strings(const std::vector<std::string>& strs) {
+            std::string ret = "[";
+            for (std::size_t i = 0; i != strs.size(); i++) {
+                if (i != 0)
+                    ret += ", ";
+                ret += json_string(strs[i]);
+            }
+            return ret + "]";
+        }
+
+        std::string csv_field(const std::string& str) {
+            if (str.find_first_of(",\"\n") == std::string::npos)
+                return str;
+            std::string ret = "\"";
+            for (char c : str) {
+                if (c == '"')
+                    ret += '"';
+                ret += c;
+            }
+            return ret + "\"";
+        }
+    };
+
+    std::string result_status(const BasicTestResult& result) {
+        if (result.exec_result)
+            return "ok";
+        if (result.crashed)
+            return "crashed";
+        return "failed";
+    }
+
+    void JSONStatOutputMethod::add_test(std::string test_name) {
+        tests_.push_back(TestInfo{ test_name, "single", {}, 1 });
+    }
+
+    void JSONStatOutputMethod::add_multiparam_test(std::string test_name, std::vector<std::string> params) {
+        tests_.push_back(TestInfo{ test_name, "multiparam", params, 1 });
+    }
+
+    void JSONStatOutputMethod::add_multitest(std::string test_name, int test_num) {
+        tests_.push_back(TestInfo{ test_name, "multitest", {}, test_num });
+    }
+
+    void JSONStatOutputMethod::print(std::string solution_name, std::deque<TestResultPtr> tr) {
+        solution_name_ = solution_name;
+        for (auto& res : tr)
+            res->print_test(*this);
+    }
+
+    void JSONStatOutputMethod::begin_result(const BasicTestResult& result) {
+        if (!first_result_)
+            results_ << ",";
+        first_result_ = false;
+        results_ << "\n    {\"solution\": " << json_string(solution_name_)
+                 << ", \"test\": " << json_string(result.test_name)
+                 << ", \"status\": " << json_string(result_status(result))
+                 << ", \"trials\": " << result.num_trials()
+                 << ", \"values\": [";
+    }
+
+    void JSONStatOutputMethod::end_result(const BasicTestResult& result) {
+        results_ << "]";
+        if (result.usage.valid) {
+            results_ << ", \"usage\": {\"max_rss_kb\": " << result.usage.max_rss
+                     << ", \"minor_faults\": " << result.usage.minor_faults
+                     << ", \"major_faults\": " << result.usage.major_faults
+                     << ", \"voluntary_switches\": " << result.usage.voluntary_switches
+                     << ", \"involuntary_switches\": " << result.usage.involuntary_switches << "}";
+        }
+        if (result.contention.valid) {
+            const ContentionStats& contention = result.contention;
+            results_ << ", \"contention\": {\"threads\": " << contention.threads
+                     << ", \"single_seconds\": " << json_number(contention.single_seconds)
+                     << ", \"thread_seconds\": " << json_number(contention.thread_seconds)
+                     << ", \"wall_seconds\": " << json_number(contention.wall_seconds)
+                     << ", \"ops_per_trial\": " << contention.ops_per_trial
+                     << ", \"throughput\": " << json_number(contention.throughput())
+                     << ", \"slowdown\": " << json_number(contention.slowdown()) << "}";
+        }
+        if (result.allocations.valid) {
+            const AllocationStats& allocations = result.allocations;
+            results_ << ", \"allocations\": {\"count\": " << allocations.count
+                     << ", \"bytes\": " << allocations.bytes
+                     << ", \"peak_bytes\": " << allocations.peak_bytes
+                     << ", \"size_histogram\": {";
+            bool first = true;
+            for (int i = 0; i < AllocationStats::histogram_buckets; i++) {
+                if (allocations.size_histogram[i] == 0)
+                    continue;
+                results_ << (first ? "" : ", ") << json_string(AllocationStats::bucket_name(i)) << ": "
+                         << allocations.size_histogram[i];
+                first = false;
+            }
+            results_ << "}, \"checkpoints\": [";
+            for (std::size_t i = 0; i != allocations.checkpoints.size(); i++) {
+                const MemoryCheckpoint& checkpoint = allocations.checkpoints[i];
+                results_ << (i == 0 ? "" : ", ") << "{\"name\": " << json_string(checkpoint.name)
+                         << ", \"live_bytes\": " << checkpoint.live_bytes
+                         << ", \"elements\": " << checkpoint.elements
+                         << ", \"bytes_per_element\": " << json_number(checkpoint.bytes_per_element()) << "}";
+            }
+            results_ << "]}";
+        }
+        results_ << "}";
+    }
+
+    void JSONStatOutputMethod::print_value(const BasicTestResult& result, const std::string& param,
+                                           std::chrono::nanoseconds exec_time, const Samples& samples,
+                                           const CounterValues& counters, long long ops,
+                                           const LatencyHistogram* histogram) {
+        results_ << "\n      {\"param\": " << (param.empty() ? "null" : json_string(param))
+                 << ", \"time_ns\": " << exec_time.count()
+                 << ", \"ops\": " << ops
+                 << ", \"samples_ns\": [";
+        for (std::size_t i = 0; i != samples.size(); i++)
+            results_ << (i == 0 ? "" : ", ") << samples[i].count();
+        results_ << "]";
+        if (!samples.empty()) {
+            SampleStats st = compute_stats(samples);
+            results_ << ", \"stats_s\": {\"min\": " << json_number(st.min)
+                     << ", \"median\": " << json_number(st.median)
+                     << ", \"mean\": " << json_number(st.mean)
+                     << ", \"stddev\": " << json_number(st.stddev)
+                     << ", \"mad\": " << json_number(st.mad)
+                     << ", \"ci_low\": " << json_number(st.ci_low)
+                     << ", \"ci_high\": " << json_number(st.ci_high) << "}";
+        }
+        if (st_config.baseline.get() != nullptr) {
+            Comparison cmp = st_config.compare_to_baseline(result, param, samples);
+            results_ << ", \"baseline\": {\"speedup\": " << json_number(cmp.speedup)
+                     << ", \"p_value\": " << json_number(cmp.p_value) << "}";
+        }
+        if (st_config.perf_counters) {
+            results_ << ", \"counters\": {";
+            for (int event = 0; event < CounterValues::NumEvents; event++) {
+                results_ << (event == 0 ? "" : ", ") << json_string(CounterValues::event_name(event)) << ": "
+                         << (counters.valid[event] ? json_number(counters.value[event]) : "null");
+            }
+            results_ << "}";
+        }
+        if (histogram != nullptr && st_config.histograms) {
+            results_ << ", \"latency_ns\": {";
+            for (double q : reported_quantiles) {
+                std::ostringstream name;
+                name << "p" << q * 100;
+                results_ << json_string(name.str()) << ": " << histogram->quantile(q) << ", ";
+            }
+            results_ << "\"max\": " << histogram->max() << "}";
+        }
+        results_ << "}";
+    }
+
+    void JSONStatOutputMethod::print_multitest_result(MultitestResult result) {
+        begin_result(result);
+        print_value(result, "", result.exec_time, result.samples, result.counters, result.ops, nullptr);
+        end_result(result);
+    }
+
+    void JSONStatOutputMethod::print_multiparam_test_result(MultiparamTestResult result) {
+        begin_result(result);
+        std::vector<std::string> params;
+        for (auto& test : tests_) {
+            if (test.name == result.test_name)
+                params = test.params;
+        }
+        for (std::size_t i = 0; i != params.size(); i++) {
+            if (i != 0)
+                results_ << ",";
+            const std::string& param = params[i];
+            print_value(result, param, result.exec_time[param], result.samples[param], result.counters[param],
+                        result.invocations[param], &result.histograms[param]);
+        }
+        end_result(result);
+    }
+
+    void JSONStatOutputMethod::print_single_test_result(SingleTestResult result) {
+        begin_result(result);
+        print_value(result, "", result.exec_time, result.samples, result.counters, result.ops, nullptr);
+        end_result(result);
+    }
+
+    void JSONStatOutputMethod::print_sweep(const SweepReport& report) {
+        std::ostringstream& out = sweeps_;
+        out << (sweeps_.tellp() == 0 ? "" : ",") << "\n    {\"test\": " << json_string(report.test_name)
+            << ", \"sizes\": [";
+        for (std::size_t i = 0; i != report.sizes.size(); i++)
+            out << (i == 0 ? "" : ", ") << report.sizes[i];
+        out << "], \"rows\": [";
+        for (std::size_t i = 0; i != report.rows.size(); i++) {
+            const SweepReport::Row& row = report.rows[i];
+            out << (i == 0 ? "" : ",") << "\n      {\"solution\": " << json_string(row.solution_name)
+                << ", \"status\": " << json_string(row.exec_result ? "ok" : "failed") << ", \"seconds\": [";
+            for (std::size_t j = 0; j != row.seconds.size(); j++)
+                out << (j == 0 ? "" : ", ") << json_number(row.seconds[j]);
+            out << "]";
+            if (row.fit.valid) {
+                out << ", \"fit\": {\"model\": " << json_string(row.fit.model)
+                    << ", \"constant_s\": " << json_number(row.fit.constant)
+                    << ", \"exponent\": " << row.fit.exponent
+                    << ", \"error\": " << json_number(row.fit.error) << "}";
+            }
+            out << "}";
+        }
+        out << "], \"crossovers\": [";
+        for (std::size_t i = 0; i != report.crossovers.size(); i++) {
+            const SweepReport::Crossover& crossover = report.crossovers[i];
+            out << (i == 0 ? "" : ", ") << "{\"faster_below\": " << json_string(crossover.faster_below)
+                << ", \"faster_above\": " << json_string(crossover.faster_above)
+                << ", \"size\": " << json_number(crossover.size) << "}";
+        }
+        out << "]}";
+    }
+
+    void JSONStatOutputMethod::flush() {
+        std::ostringstream out;
+        out << "{\n  \"environment\": {";
+        std::vector<std::pair<std::string, std::string> > env = environment_info();
+        for (std::size_t i = 0; i != env.size(); i++) {
+            out << (i == 0 ? "" : ",") << "\n    " << json_string(env[i].first) << ": "
+                << json_string(env[i].second);
+        }
+        out << "\n  },\n  \"config\": {\"trials\": " << st_config.trials
+            << ", \"target_ci\": " << st_config.target_ci
+            << ", \"max_trials\": " << st_config.max_trials
+            << ", \"clock\": " << json_string(clock_name())
+            << ", \"jobs\": " << st_config.jobs << "},";
+        out << "\n  \"tests\": [";
+        for (std::size_t i = 0; i != tests_.size(); i++) {
+            const TestInfo& test = tests_[i];
+            out << (i == 0 ? "" : ",") << "\n    {\"name\": " << json_string(test.name)
+                << ", \"type\": " << json_string(test.type);
+            if (test.type == "multiparam")
+                out << ", \"params\": " << json_strings(test.params);
+            if (test.type == "multitest")
+                out << ", \"num_tests\": " << test.num_tests;
+            out << "}";
+        }
+        out << "\n  ],\n  \"results\": [" << results_.str() << "\n  ],";
+        out << "\n  \"sweeps\": [" << sweeps_.str() << "\n  ]\n}";
+        std::cout << out.str() << std::endl;
+    }
+
+    const std::vector<std::string> CSVStatOutputMethod::columns = {
+        "solution", "test", "param", "status", "trial", "time_ns"
+    };
+
+    void CSVStatOutputMethod::add_multiparam_test(std::string test_name, std::vector<std::string> params) {
+        param_map_[test_name] = params;
+    }
+
+    void CSVStatOutputMethod::print(std::string solution_name, std::deque<TestResultPtr> tr) {
+        solution_name_ = solution_name;
+        for (auto& res : tr)
+            res->print_test(*this);
+    }
+
+    // A cell without samples still gets a row, so that failures are recorded.
+    void CSVStatOutputMethod::print_samples(const BasicTestResult& result, const std::string& param,
+                                            const Samples& samples) {
+        std::string prefix = csv_field(solution_name_) + "," + csv_field(result.test_name) + ","
+            + csv_field(param) + "," + result_status(result) + ",";
+        if (samples.empty())
+            rows_ << prefix << "," << "\n";
+        for (std::size_t i = 0; i != samples.size(); i++)
+            rows_ << prefix << i << "," << samples[i].count() << "\n";
+    }
+
+    void CSVStatOutputMethod::print_multitest_result(MultitestResult result) {
+        print_samples(result, "", result.samples);
+    }
+
+    void CSVStatOutputMethod::print_multiparam_test_result(MultiparamTestResult result) {
+        for (auto& param : param_map_[result.test_name])
+            print_samples(result, param, result.samples[param]);
+    }
+
+    void CSVStatOutputMethod::print_single_test_result(SingleTestResult result) {
+        print_samples(result, "", result.samples);
+    }
+
+    // Every size of a sweep is written as a separate test already.
+    void CSVStatOutputMethod::print_sweep(const SweepReport&) {}
+
+    void CSVStatOutputMethod::flush() {
+        std::ostringstream out;
+        for (auto& field : environment_info())
+            out << "# " << field.first << ": " << field.second << "\n";
+        for (std::size_t i = 0; i != columns.size(); i++)
+            out << (i == 0 ? "" : ",") << columns[i];
+        out << "\n" << rows_.str();
+        std::cout << out.str();
+    }
+};
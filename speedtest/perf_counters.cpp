@@ -0,0 +1,215 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/perf_counters.h>
+#include <speedtest/speedtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace speedtest {
+    std::string CounterValues::event_name(int event) {
+        switch (event) {
+        case Cycles:
+            return "cycles";
+        case Instructions:
+            return "instructions";
+        case L1dMisses:
+            return "L1d";
+        case LLCMisses:
+            return "LLC";
+        case BranchMisses:
+            return "br";
+        case DTLBMisses:
+            return "dTLB";
+        default:
+            return "";
+        }
+    }
+
+    CounterValues& CounterValues::operator+=(const CounterValues& other) {
+        for (int i = 0; i < NumEvents; i++) {
+            value[i] += other.value[i];
+            valid[i] = valid[i] || other.valid[i];
+        }
+        return *this;
+    }
+
+    CounterValues CounterValues::operator-(const CounterValues& other) const {
+        CounterValues ret;
+        for (int i = 0; i < NumEvents; i++) {
+            ret.value[i] = value[i] - other.value[i];
+            ret.valid[i] = valid[i] && other.valid[i];
+        }
+        return ret;
+    }
+
+    void CounterValues::remove_baseline(const CounterValues& base, long long base_ops, long long ops) {
+        if (base_ops <= 0)
+            return;
+        for (int i = 0; i < NumEvents; i++) {
+            if (valid[i] && base.valid[i])
+                value[i] = std::max(0.0, value[i] - base.value[i] / base_ops * ops);
+        }
+    }
+
+    bool CounterValues::any_valid() const {
+        return std::find(valid, valid + NumEvents, true) != valid + NumEvents;
+    }
+
+    double CounterValues::ipc() const {
+        if (!valid[Cycles] || !valid[Instructions] || value[Cycles] == 0)
+            return -1;
+        return value[Instructions] / value[Cycles];
+    }
+
+    double CounterValues::per_op(int event, long long ops) const {
+        if (!valid[event] || ops <= 0)
+            return -1;
+        return value[event] / ops;
+    }
+
+#ifdef __linux__
+    namespace {
+        void event_attr(int event, perf_event_attr& attr) {
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            switch (event) {
+            case CounterValues::Cycles:
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case CounterValues::Instructions:
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case CounterValues::L1dMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D
+                            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            case CounterValues::LLCMisses:
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case CounterValues::BranchMisses:
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case CounterValues::DTLBMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_DTLB
+                            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            }
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID
+                             | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        }
+
+        int open_event(int event, int group) {
+            perf_event_attr attr;
+            event_attr(event, attr);
+            return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+        }
+    };
+
+    PerfCounters::PerfCounters() : leader_(-1) {
+        for (int i = 0; i < CounterValues::NumEvents; i++) {
+            fd_[i] = open_event(i, leader_);
+            if (fd_[i] >= 0) {
+                if (leader_ < 0)
+                    leader_ = fd_[i];
+                ioctl(fd_[i], PERF_EVENT_IOC_ID, &id_[i]);
+            }
+        }
+    }
+
+    PerfCounters::~PerfCounters() {
+        for (int i = 0; i < CounterValues::NumEvents; i++) {
+            if (fd_[i] >= 0)
+                close(fd_[i]);
+        }
+    }
+
+    bool PerfCounters::available() const {
+        return leader_ >= 0;
+    }
+
+    CounterValues PerfCounters::read() const {
+        CounterValues ret;
+        if (leader_ < 0)
+            return ret;
+
+        // struct read_format { nr, time_enabled, time_running, { value, id }[nr] }
+        std::uint64_t buf[3 + 2 * CounterValues::NumEvents];
+        if (::read(leader_, buf, sizeof(buf)) <= 0)
+            return ret;
+        std::uint64_t nr = buf[0];
+        // A group larger than the PMU may never get on it, then nothing was counted.
+        if (buf[2] == 0) {
+            static std::atomic<bool> warned(false);
+            if (!warned.exchange(true))
+                log_message("Warning: the performance counter group could not be scheduled on the PMU, the counters are unavailable");
+            return ret;
+        }
+        // The counters are multiplexed if there are more of them than the PMU has.
+        double scale = (double)buf[1] / buf[2];
+        for (std::uint64_t j = 0; j < nr; j++) {
+            for (int i = 0; i < CounterValues::NumEvents; i++) {
+                if (fd_[i] >= 0 && id_[i] == buf[4 + 2 * j]) {
+                    ret.value[i] = buf[3 + 2 * j] * scale;
+                    ret.valid[i] = true;
+                }
+            }
+        }
+        return ret;
+    }
+#else
+    PerfCounters::PerfCounters() : leader_(-1) {}
+
+    PerfCounters::~PerfCounters() {}
+
+    bool PerfCounters::available() const {
+        return false;
+    }
+
+    CounterValues PerfCounters::read() const {
+        return CounterValues();
+    }
+#endif
+
+    PerfCounters& PerfCounters::thread_instance() {
+        static thread_local PerfCounters instance;
+        return instance;
+    }
+};
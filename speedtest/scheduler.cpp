@@ -0,0 +1,137 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/scheduler.h>
+#include <speedtest/speedtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace speedtest {
+    namespace {
+        int read_topology(int cpu, const std::string& name) {
+            std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+            int ret = -1;
+            in >> ret;
+            return ret;
+        }
+
+        bool pin_to_cpu(int cpu) {
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+            return false;
+#endif
+        }
+    };
+
+    Scheduler::Scheduler(int jobs, bool reserve_siblings) : jobs_(jobs), reserve_siblings_(reserve_siblings) {}
+
+    void Scheduler::add(Task task, std::shared_ptr<BasicTestResult>* slot) {
+        tasks_.push_back(Entry{ std::move(task), slot });
+    }
+
+    std::vector<int> Scheduler::worker_cpus(bool reserve_siblings) {
+        std::vector<int> allowed;
+#ifdef __linux__
+        cpu_set_t set;
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set))
+                    allowed.push_back(cpu);
+            }
+        }
+#endif
+        if (allowed.empty()) {
+            for (int cpu = 0; cpu < (int)std::thread::hardware_concurrency(); cpu++)
+                allowed.push_back(cpu);
+        }
+
+        // (package, core) -> logical CPUs of that physical core
+        std::map<std::pair<int, int>, std::vector<int> > cores;
+        for (int cpu : allowed) {
+            int core = read_topology(cpu, "core_id");
+            int package = read_topology(cpu, "physical_package_id");
+            if (core < 0)
+                core = cpu;
+            cores[std::make_pair(package, core)].push_back(cpu);
+        }
+
+        std::vector<int> primary, siblings;
+        for (auto& core : cores) {
+            primary.push_back(core.second[0]);
+            siblings.insert(siblings.end(), core.second.begin() + 1, core.second.end());
+        }
+        if (!reserve_siblings)
+            primary.insert(primary.end(), siblings.begin(), siblings.end());
+        return primary;
+    }
+
+    void Scheduler::run() {
+        if (jobs_ <= 1) {
+            for (auto& entry : tasks_)
+                *entry.slot = entry.task();
+            tasks_.clear();
+            return;
+        }
+
+        std::vector<int> cpus = worker_cpus(reserve_siblings_);
+        int workers = std::min<int>(jobs_, tasks_.size());
+        static std::atomic<bool> warned(false);
+        if (workers > (int)cpus.size() && !warned.exchange(true)) {
+            std::ostringstream ss;
+            ss << "Warning: " << workers << " jobs requested, but only " << cpus.size()
+               << " cores are available, some workers will share cores";
+            log_message(ss.str());
+        }
+
+        std::atomic<std::size_t> next(0);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < workers; i++) {
+            int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+            threads.emplace_back([this, &next, cpu]() {
+                if (cpu >= 0 && !pin_to_cpu(cpu))
+                    log_message("Warning: failed to pin a worker to CPU " + std::to_string(cpu));
+                for (std::size_t i = next++; i < tasks_.size(); i = next++)
+                    *tasks_[i].slot = tasks_[i].task();
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        tasks_.clear();
+    }
+};
@@ -23,10 +23,18 @@
 
 #include <speedtest/speedtest.h>
 #include <speedtest/runtime.h>
+#include <speedtest/machine_output.h>
 #include <ascii_table/ascii_table.h>
+#include <cmath>
 #include <cstring>
+#include <cstdlib>
+#include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <mutex>
+#include <regex>
+
+#include <unistd.h>
 
 template<>
 class TypedCell<double> : public Cell {
@@ -46,11 +54,210 @@ private:
     double value_;
 };
 
+// A dimensionless value. Negative values mean that the value is unknown.
+struct Scalar {
+    double value;
+    int precision;
+};
+
+template<>
+class TypedCell<Scalar> : public Cell {
+public:
+    TypedCell(Scalar val) : value_(val) {}
+    virtual ~TypedCell() {}
+
+    virtual std::string show(std::size_t maxlen) const {
+        std::ostringstream ss;
+        if (value_.value < 0) {
+            ss << "n/a";
+        } else {
+            ss.precision(value_.precision);
+            ss << std::fixed << value_.value;
+        }
+        if (ss.str().length() > maxlen)
+            throw CellLengthException(ss.str(), maxlen);
+        return ss.str();
+    }
+private:
+    Scalar value_;
+};
+
 namespace speedtest {
     std::unique_ptr<BasicSpeedTest> st_instance;
-    std::shared_ptr<MultiparamTestResult> currentMultiparamInvocation;
+    thread_local std::shared_ptr<MultiparamTestResult> currentMultiparamInvocation;
     SpeedTestConfig st_config;
+
+    void log_message(const std::string& message) {
+        static std::mutex log_mutex;
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::cerr << message << std::endl;
+    }
+
+    namespace {
+        // Empty filters select everything.
+        std::unique_ptr<std::regex> solution_filter, test_filter;
+
+        void set_filter(std::unique_ptr<std::regex>& filter, const std::string& option, const std::string& value) {
+            try {
+                filter.reset(new std::regex(value, std::regex::extended));
+            } catch (const std::regex_error& e) {
+                std::cerr << "Error: " << option << ": invalid regular expression " << value << std::endl;
+                exit(1);
+            }
+        }
+    };
+
+    bool solution_selected(const std::string& name) {
+        return solution_filter.get() == nullptr || std::regex_search(name, *solution_filter);
+    }
+
+    bool test_selected(const std::string& name) {
+        return test_filter.get() == nullptr || std::regex_search(name, *test_filter);
+    }
     
+    namespace {
+        const std::vector<std::string> stat_names = {
+            "min", "median", "mean", "stddev", "mad", "ci low", "ci high"
+        };
+
+        std::vector<std::string> stat_columns(const std::string& prefix) {
+            std::vector<std::string> ret;
+            for (auto& name : stat_names)
+                ret.push_back(prefix + name);
+            return ret;
+        }
+
+        std::vector<double> stat_values(const SampleStats& st) {
+            return { st.min, st.median, st.mean, st.stddev, st.mad, st.ci_low, st.ci_high };
+        }
+
+        // Counters shown per operation, cycles and instructions are shown as IPC.
+        const std::vector<int> per_op_events = {
+            CounterValues::L1dMisses, CounterValues::LLCMisses, CounterValues::BranchMisses, CounterValues::DTLBMisses
+        };
+
+        std::vector<std::string> counter_columns(const std::string& prefix) {
+            std::vector<std::string> ret = { prefix + "ipc" };
+            for (int event : per_op_events)
+                ret.push_back(prefix + CounterValues::event_name(event) + "/op");
+            return ret;
+        }
+
+        std::string column_prefix(const std::string& name) {
+            return name.empty() ? "" : name + " ";
+        }
+
+        // Subcolumns shown for every measured value.
+        std::vector<std::string> value_columns(const std::string& name) {
+            std::vector<std::string> ret;
+            if (st_config.collect_stats())
+                ret = stat_columns(column_prefix(name));
+            else
+                ret.push_back(name.empty() ? "time" : name);
+            if (st_config.baseline.get() != nullptr) {
+                ret.push_back(column_prefix(name) + "speedup");
+                ret.push_back(column_prefix(name) + "p");
+            }
+            if (st_config.perf_counters) {
+                std::vector<std::string> counters = counter_columns(column_prefix(name));
+                ret.insert(ret.end(), counters.begin(), counters.end());
+            }
+            return ret;
+        }
+
+        const std::vector<std::string> usage_columns = {
+            "rss MB", "minflt", "majflt", "vcsw", "ivcsw"
+        };
+
+        std::vector<double> usage_values(const ResourceUsage& usage) {
+            if (!usage.valid)
+                return std::vector<double>(usage_columns.size(), -1);
+            return { usage.max_rss / 1024.0, (double)usage.minor_faults, (double)usage.major_faults,
+                     (double)usage.voluntary_switches, (double)usage.involuntary_switches };
+        }
+
+        std::string quantile_name(double q) {
+            std::ostringstream ss;
+            ss << "p" << q * 100;
+            return ss.str();
+        }
+
+        void add_histogram_columns(std::vector<std::string>& subcolumns, const std::string& param) {
+            if (!st_config.histograms)
+                return;
+            for (double q : reported_quantiles)
+                subcolumns.push_back(param + " " + quantile_name(q) + " ns");
+            subcolumns.push_back(param + " max ns");
+        }
+
+        const std::vector<std::string> allocation_columns = {
+            "allocs", "alloc MB", "peak MB", "top size"
+        };
+
+        const std::vector<std::string> contention_columns = {
+            "ops/s", "slowdown"
+        };
+
+        std::string contention_prefix() {
+            return std::to_string(st_config.threads) + " thr ";
+        }
+
+        const std::vector<std::string> memory_columns = {
+            "peak MB", "bytes/elem"
+        };
+
+        // E.g. "build: 48.0, end: 47.9".
+        std::string checkpoints_summary(const AllocationStats& allocations) {
+            std::ostringstream ss;
+            ss.precision(1);
+            ss << std::fixed;
+            for (std::size_t i = 0; i != allocations.checkpoints.size(); i++) {
+                const MemoryCheckpoint& checkpoint = allocations.checkpoints[i];
+                ss << (i == 0 ? "" : ", ") << checkpoint.name << ": ";
+                if (checkpoint.bytes_per_element() < 0)
+                    ss << "n/a";
+                else
+                    ss << checkpoint.bytes_per_element();
+            }
+            return allocations.checkpoints.empty() ? "-" : ss.str();
+        }
+
+        // Usage, allocation and memory columns go after all the measured values.
+        void add_usage_columns(std::vector<std::string>& subcolumns) {
+            if (st_config.isolate)
+                subcolumns.insert(subcolumns.end(), usage_columns.begin(), usage_columns.end());
+            if (st_config.track_allocations)
+                subcolumns.insert(subcolumns.end(), allocation_columns.begin(), allocation_columns.end());
+            if (st_config.memory)
+                subcolumns.insert(subcolumns.end(), memory_columns.begin(), memory_columns.end());
+            if (st_config.threads > 1) {
+                for (auto& column : contention_columns)
+                    subcolumns.push_back(contention_prefix() + column);
+            }
+        }
+
+        std::string scientific(double value, const std::string& unit) {
+            std::ostringstream ss;
+            ss.precision(3);
+            ss << std::scientific << value << unit;
+            return ss.str();
+        }
+
+        std::string crossover_message(const SweepReport::Crossover& crossover) {
+            std::ostringstream ss;
+            ss << crossover.faster_below << " is faster below n = " << std::llround(crossover.size)
+               << ", " << crossover.faster_above << " is faster above";
+            return ss.str();
+        }
+
+        void warn_no_counters() {
+            static bool warned = false;
+            if (!warned)
+                log_message("Warning: hardware performance counters are unavailable");
+            warned = true;
+        }
+    };
+
     class PlainTextStatOutputMethod : public StatOutputMethod {
     public:
         PlainTextStatOutputMethod() {
@@ -73,41 +280,181 @@ namespace speedtest {
             out << "Solution " << result.solution_name;
             if (result.exec_result)
                 out << " succeeded ";
+            else if (result.crashed)
+                out << " crashed ";
             else
                 out << " failed ";
             out << "on test " << result.test_name;
             out << ". Time: " << (double)result.exec_time.count() / 1e9 << " s";
             out << " (avg: " << (double) result.exec_time.count() / result.test_num / 1e9 << " s)";
+            print_stats(result.samples);
+            print_comparison(st_config.compare_to_baseline(result, "", result.samples));
+            print_counters(result.counters, result.ops);
+            print_usage(result);
             out << std::endl;
         }
         virtual void print_multiparam_test_result(MultiparamTestResult result) {
             out << "Solution " << result.solution_name;
             if (result.exec_result)
                 out << " succeeded ";
+            else if (result.crashed)
+                out << " crashed ";
             else
                 out << " failed ";
             out << "on test " << result.test_name;
             out << ". Measured time: ";
-            for (std::string param : param_map_[result.test_name]) {
-                out << param << ": " << result.exec_time[param].count() / 1e9 << " s";
-                if (param != param_map_[result.test_name][param_map_.size() - 1])
+            const std::vector<std::string>& params = param_map_[result.test_name];
+            for (std::size_t i = 0; i != params.size(); i++) {
+                out << params[i] << ": " << result.exec_time[params[i]].count() / 1e9 << " s";
+                print_stats(result.samples[params[i]]);
+                print_comparison(st_config.compare_to_baseline(result, params[i], result.samples[params[i]]));
+                print_counters(result.counters[params[i]], result.invocations[params[i]]);
+                print_histogram(result.histograms[params[i]]);
+                if (i + 1 != params.size())
                     out << ", ";
             }
-            out << "." << std::endl;
+            out << ".";
+            print_usage(result);
+            out << std::endl;
         }
         virtual void print_single_test_result(SingleTestResult result) {
             out << "Solution " << result.solution_name;
             if (result.exec_result)
                 out << " succeeded ";
+            else if (result.crashed)
+                out << " crashed ";
             else
                 out << " failed ";
             out << "on test " << result.test_name;
-            out << ". Time: " << (double)result.exec_time.count() / 1e9 << " s" << std::endl;
+            out << ". Time: " << (double)result.exec_time.count() / 1e9 << " s";
+            print_stats(result.samples);
+            print_comparison(st_config.compare_to_baseline(result, "", result.samples));
+            print_counters(result.counters, result.ops);
+            print_usage(result);
+            out << std::endl;
+        }
+        virtual void print_sweep(const SweepReport& report) {
+            for (auto& row : report.rows) {
+                out << "Sweep " << report.test_name << ", solution " << row.solution_name;
+                if (!row.exec_result) {
+                    out << " failed." << std::endl;
+                    continue;
+                }
+                out << ". Times:";
+                for (std::size_t i = 0; i != report.sizes.size(); i++)
+                    out << (i == 0 ? " " : ", ") << "n=" << report.sizes[i] << ": " << row.seconds[i] << " s";
+                if (row.fit.valid) {
+                    out << ". Fit: " << scientific(row.fit.constant, " s") << " * " << row.fit.model
+                        << " (exponent: " << row.fit.exponent << ", error: " << row.fit.error << ")";
+                }
+                out << "." << std::endl;
+            }
+            for (auto& crossover : report.crossovers)
+                out << "Sweep " << report.test_name << ": " << crossover_message(crossover) << "." << std::endl;
         }
         virtual void flush() {
             std::cout << out.str();
         }
     private:
+        void print_stats(const Samples& samples) {
+            if (!st_config.collect_stats())
+                return;
+            SampleStats st = compute_stats(samples);
+            out << " [trials: " << st.count;
+            std::vector<double> values = stat_values(st);
+            for (std::size_t i = 0; i != stat_names.size(); i++)
+                out << ", " << stat_names[i] << ": " << values[i] << " s";
+            out << "]";
+        }
+
+        void print_comparison(const Comparison& cmp) {
+            if (st_config.baseline.get() == nullptr)
+                return;
+            if (!cmp.valid()) {
+                out << " [baseline: n/a]";
+                return;
+            }
+            out << " [speedup: " << cmp.speedup << ", p: " << cmp.p_value << "]";
+        }
+
+        void print_histogram(const LatencyHistogram& histogram) {
+            if (!st_config.histograms)
+                return;
+            out << " [invocations: " << histogram.total();
+            for (double q : reported_quantiles)
+                out << ", " << quantile_name(q) << ": " << histogram.quantile(q) << " ns";
+            out << ", max: " << histogram.max() << " ns]";
+        }
+
+        void print_usage(const BasicTestResult& result) {
+            print_allocations(result.allocations);
+            print_contention(result.contention);
+            if (!result.usage.valid)
+                return;
+            out << " [peak rss growth: " << result.usage.max_rss / 1024.0 << " MB"
+                << ", minor faults: " << result.usage.minor_faults
+                << ", major faults: " << result.usage.major_faults
+                << ", voluntary switches: " << result.usage.voluntary_switches
+                << ", involuntary switches: " << result.usage.involuntary_switches << "]";
+        }
+
+        void print_memory(const AllocationStats& allocations) {
+            if (!st_config.memory || !allocations.valid)
+                return;
+            out << " [peak bytes: " << allocations.peak_bytes;
+            for (auto& checkpoint : allocations.checkpoints) {
+                out << ", " << checkpoint.name << ": " << checkpoint.live_bytes << " bytes";
+                if (checkpoint.bytes_per_element() >= 0)
+                    out << " (" << checkpoint.bytes_per_element() << " per element)";
+            }
+            out << "]";
+        }
+
+        void print_contention(const ContentionStats& contention) {
+            if (!contention.valid)
+                return;
+            out << " [threads: " << contention.threads << ", aggregate ops/s: " << contention.throughput()
+                << ", slowdown: " << contention.slowdown() << "]";
+        }
+
+        void print_allocations(const AllocationStats& allocations) {
+            print_memory(allocations);
+            if (!st_config.track_allocations || !allocations.valid)
+                return;
+            out << " [allocations: " << allocations.count << ", bytes: " << allocations.bytes
+                << ", peak bytes: " << allocations.peak_bytes;
+            for (int i = 0; i < AllocationStats::histogram_buckets; i++) {
+                if (allocations.size_histogram[i] > 0)
+                    out << ", " << AllocationStats::bucket_name(i) << ": " << allocations.size_histogram[i];
+            }
+            out << "]";
+        }
+
+        void print_counters(const CounterValues& counters, long long ops) {
+            if (!st_config.perf_counters)
+                return;
+            if (!counters.any_valid()) {
+                warn_no_counters();
+                out << " [counters: n/a]";
+                return;
+            }
+            out << " [ops: " << ops;
+            for (int event = 0; event < CounterValues::NumEvents; event++) {
+                out << ", " << CounterValues::event_name(event) << ": ";
+                if (counters.valid[event])
+                    out << (long long)counters.value[event];
+                else
+                    out << "n/a";
+            }
+            if (counters.ipc() >= 0)
+                out << ", ipc: " << counters.ipc();
+            for (int event : per_op_events) {
+                if (counters.per_op(event, ops) >= 0)
+                    out << ", " << CounterValues::event_name(event) << "/op: " << counters.per_op(event, ops);
+            }
+            out << "]";
+        }
+
         std::ostringstream out;
         std::map<std::string, std::vector<std::string> > param_map_;
     };
@@ -120,17 +467,31 @@ namespace speedtest {
         virtual ~ASCIITableStatOutputMethod() {}
 
         virtual void add_test(std::string test_name) {
-            table_.addColumn(Column(Column::Header(test_name, {})));
+            std::vector<std::string> subcolumns = value_columns("");
+            add_usage_columns(subcolumns);
+            if (subcolumns.size() == 1)
+                subcolumns.clear();
+            table_.addColumn(Column(Column::Header(test_name, subcolumns)));
         }
         virtual void add_multiparam_test(std::string test_name, std::vector<std::string> params) {
             param_map_[test_name] = params;
-            table_.addColumn(Column(Column::Header(test_name, params)));
+            std::vector<std::string> subcolumns;
+            for (auto& param : params) {
+                std::vector<std::string> param_columns = value_columns(param);
+                subcolumns.insert(subcolumns.end(), param_columns.begin(), param_columns.end());
+                add_histogram_columns(subcolumns, param);
+            }
+            add_usage_columns(subcolumns);
+            table_.addColumn(Column(Column::Header(test_name, subcolumns)));
         }
         virtual void add_multitest(std::string test_name, int num_tests) {
-            if (num_tests == 1)
+            if (num_tests == 1) {
                 add_test(test_name);
-            else {
-                table_.addColumn(Column(Column::Header(test_name, {"total", "avg"})));
+            } else {
+                std::vector<std::string> subcolumns = value_columns("total");
+                subcolumns.push_back("avg");
+                add_usage_columns(subcolumns);
+                table_.addColumn(Column(Column::Header(test_name, subcolumns)));
             }
         }
         std::vector<CellPtr> table_row;
@@ -143,38 +504,217 @@ namespace speedtest {
             table_.addRow(table_row);
         }
         virtual void print_multitest_result(MultitestResult result) {
-            if (result.exec_result) {
-                table_row.push_back(make_cell<double>((double) result.exec_time.count() / 1e9));
-                table_row.push_back(make_cell<double>((double) result.exec_time.count() / result.test_num / 1e9));
-            } else {
-                table_row.push_back(make_cell<std::string>("FAIL"));
-                table_row.push_back(make_cell<std::string>("FAIL"));
-            }
+            push_value(result, "", result.exec_time, result.samples, result.counters, result.ops);
+            if (result.test_num != 1)
+                push_cell(result, make_cell<double>((double) result.exec_time.count() / result.test_num / 1e9));
+            push_usage(result);
+            push_allocations(result);
+            push_memory(result);
+            push_contention(result);
         }
         virtual void print_multiparam_test_result(MultiparamTestResult result) {
             for (auto param : param_map_[result.test_name]) {
-                if (result.exec_result) {
-                    table_row.push_back(make_cell<double>((double) result.exec_time[param].count() / 1e9));
-                } else {
-                    table_row.push_back(make_cell<std::string>("FAIL"));
-                }
+                push_value(result, param, result.exec_time[param], result.samples[param],
+                           result.counters[param], result.invocations[param]);
+                push_histogram(result, result.histograms[param]);
             }
+            push_usage(result);
+            push_allocations(result);
+            push_memory(result);
+            push_contention(result);
         }
         virtual void print_single_test_result(SingleTestResult result) {
-            if (result.exec_result) {
-                table_row.push_back(make_cell<double>((double) result.exec_time.count() / 1e9));
-            } else {
-                table_row.push_back(make_cell<std::string>("FAIL"));
+            push_value(result, "", result.exec_time, result.samples, result.counters, result.ops);
+            push_usage(result);
+            push_allocations(result);
+            push_memory(result);
+            push_contention(result);
+        }
+        virtual void print_sweep(const SweepReport& report) {
+            Table table;
+            table.addColumn(Column(Column::Header(report.test_name, {})));
+            for (long long n : report.sizes)
+                table.addColumn(Column(Column::Header("n=" + std::to_string(n), {})));
+            table.addColumn(Column(Column::Header("fit", { "model", "c", "exponent", "error" })));
+            for (auto& row : report.rows) {
+                std::vector<CellPtr> cells = { make_cell<std::string>(row.solution_name) };
+                for (double seconds : row.seconds)
+                    cells.push_back(make_cell<std::string>(row.exec_result ? scientific(seconds, " s") : "FAIL"));
+                if (row.fit.valid) {
+                    cells.push_back(make_cell<std::string>(row.fit.model));
+                    cells.push_back(make_cell<std::string>(scientific(row.fit.constant, " s")));
+                    cells.push_back(make_cell<Scalar>(Scalar{ row.fit.exponent, 3 }));
+                    cells.push_back(make_cell<Scalar>(Scalar{ row.fit.error, 3 }));
+                } else {
+                    for (int i = 0; i < 4; i++)
+                        cells.push_back(make_cell<std::string>("n/a"));
+                }
+                table.addRow(cells);
             }
+            std::vector<std::string> messages;
+            for (auto& crossover : report.crossovers)
+                messages.push_back(crossover_message(crossover));
+            sweeps_.push_back(std::make_pair(std::move(table), std::move(messages)));
         }
         virtual void flush() {
             table_.print();
+            for (auto& sweep : sweeps_) {
+                std::cout << std::endl;
+                sweep.first.print();
+                for (auto& message : sweep.second)
+                    std::cout << message << std::endl;
+            }
         }
     private:
+        void push_cell(const BasicTestResult& result, CellPtr cell) {
+            if (result.exec_result)
+                table_row.push_back(cell);
+            else if (result.crashed)
+                table_row.push_back(make_cell<std::string>("CRASH"));
+            else
+                table_row.push_back(make_cell<std::string>("FAIL"));
+        }
+
+        void push_histogram(const BasicTestResult& result, const LatencyHistogram& histogram) {
+            if (!st_config.histograms)
+                return;
+            for (double q : reported_quantiles)
+                push_cell(result, make_cell<Scalar>(Scalar{ (double)histogram.quantile(q), 0 }));
+            push_cell(result, make_cell<Scalar>(Scalar{ (double)histogram.max(), 0 }));
+        }
+
+        void push_usage(const BasicTestResult& result) {
+            if (!st_config.isolate)
+                return;
+            std::vector<double> values = usage_values(result.usage);
+            for (std::size_t i = 0; i != values.size(); i++)
+                table_row.push_back(make_cell<Scalar>(Scalar{ values[i], i == 0 ? 1 : 0 }));
+        }
+
+        void push_allocations(const BasicTestResult& result) {
+            if (!st_config.track_allocations)
+                return;
+            const AllocationStats& allocations = result.allocations;
+            if (!allocations.valid) {
+                for (std::size_t i = 0; i != allocation_columns.size(); i++)
+                    table_row.push_back(make_cell<std::string>("n/a"));
+                return;
+            }
+            table_row.push_back(make_cell<Scalar>(Scalar{ (double)allocations.count, 0 }));
+            table_row.push_back(make_cell<Scalar>(Scalar{ allocations.bytes / 1048576.0, 1 }));
+            table_row.push_back(make_cell<Scalar>(Scalar{ allocations.peak_bytes / 1048576.0, 1 }));
+            int top = allocations.top_bucket();
+            table_row.push_back(make_cell<std::string>(top == -1 ? "-" : AllocationStats::bucket_name(top)));
+        }
+
+        void push_contention(const BasicTestResult& result) {
+            if (st_config.threads <= 1)
+                return;
+            const ContentionStats& contention = result.contention;
+            if (!contention.valid) {
+                for (std::size_t i = 0; i != contention_columns.size(); i++)
+                    push_cell(result, make_cell<std::string>("n/a"));
+                return;
+            }
+            push_cell(result, make_cell<Scalar>(Scalar{ contention.throughput(), 0 }));
+            push_cell(result, make_cell<Scalar>(Scalar{ contention.slowdown(), 2 }));
+        }
+
+        void push_memory(const BasicTestResult& result) {
+            if (!st_config.memory)
+                return;
+            const AllocationStats& allocations = result.allocations;
+            if (!allocations.valid) {
+                for (std::size_t i = 0; i != memory_columns.size(); i++)
+                    table_row.push_back(make_cell<std::string>("n/a"));
+                return;
+            }
+            table_row.push_back(make_cell<Scalar>(Scalar{ allocations.peak_bytes / 1048576.0, 1 }));
+            table_row.push_back(make_cell<std::string>(checkpoints_summary(allocations)));
+        }
+
+        // Pushes the cells for the subcolumns given by value_columns().
+        void push_value(const BasicTestResult& result, const std::string& param, std::chrono::nanoseconds exec_time,
+                        const Samples& samples, const CounterValues& counters, long long ops) {
+            std::vector<CellPtr> cells;
+            if (st_config.collect_stats()) {
+                SampleStats st = compute_stats(samples);
+                for (double value : stat_values(st))
+                    cells.push_back(make_cell<double>(value));
+            } else {
+                cells.push_back(make_cell<double>((double) exec_time.count() / 1e9));
+            }
+            if (st_config.baseline.get() != nullptr) {
+                Comparison cmp = st_config.compare_to_baseline(result, param, samples);
+                cells.push_back(make_cell<Scalar>(Scalar{ cmp.speedup, 3 }));
+                cells.push_back(make_cell<Scalar>(Scalar{ cmp.p_value, 3 }));
+            }
+            if (st_config.perf_counters) {
+                if (!counters.any_valid())
+                    warn_no_counters();
+                cells.push_back(make_cell<Scalar>(Scalar{ counters.ipc(), 2 }));
+                for (int event : per_op_events)
+                    cells.push_back(make_cell<Scalar>(Scalar{ counters.per_op(event, ops), 3 }));
+            }
+            for (auto& cell : cells)
+                push_cell(result, cell);
+        }
+
         Table table_;
         std::map<std::string, std::vector<std::string> > param_map_;
+        // Tables and crossover messages of the sweeps.
+        std::vector<std::pair<Table, std::vector<std::string> > > sweeps_;
     };
 
+    // A tester with a single parameter: MULTIPARAMTEST_INVOKE needs an enclosing tester.
+    struct SelfTest {
+        static constexpr ParamList<1> params() {
+            return {{ "self_test" }};
+        }
+
+        void invoke(int n) {
+            for (int i = 0; i < n; i++) {
+                MULTIPARAMTEST_INVOKE("self_test", asm volatile("" ::: "memory");)
+            }
+        }
+    };
+
+    // Measures MULTIPARAMTEST_INVOKE around an empty command: the whole cost of an
+    // invocation and the part of it which gets into the measured time.
+    void self_test() {
+        const int n = 1000000;
+        const std::vector<std::string> params = tested_params<SelfTest>();
+        const std::string& param = params[0];
+
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) {
+            asm volatile("" ::: "memory");
+        }
+        auto t2 = std::chrono::steady_clock::now();
+
+        SelfTest t;
+        currentMultiparamInvocation = std::make_shared<MultiparamTestResult>();
+        currentMultiparamInvocation->start_trial(params);
+        auto t3 = std::chrono::steady_clock::now();
+        t.invoke(n);
+        auto t4 = std::chrono::steady_clock::now();
+        currentMultiparamInvocation->finish_trial(params);
+
+        double loop = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / n;
+        double total = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t4 - t3).count() / n - loop;
+        double inside = (double)currentMultiparamInvocation->exec_time[param].count() / n;
+        currentMultiparamInvocation = nullptr;
+
+        std::cout.precision(3);
+        std::cout << std::fixed;
+        std::cout << "Clock: " << clock_name();
+        if (clock_backend == ClockBackend::TSC)
+            std::cout << " (" << ns_per_tick << " ns per tick)";
+        std::cout << ", invariant TSC: " << (invariant_tsc_available() ? "yes" : "no") << std::endl;
+        std::cout << "Instrumentation overhead per invocation: " << total << " ns, of which "
+                  << inside << " ns get into the measured time" << std::endl;
+    }
+
     void usage(std::string app) {
         std::string message =
             "This is a libspeedtest application\n"
@@ -186,6 +726,73 @@ namespace speedtest {
             "                             to stderr\n"
             "      --plaintext            Do not use ASCII tables, display stats in\n"
             "                             plain text\n"
+            "      --json                 Output the results, raw samples and the\n"
+            "                             environment as a JSON document\n"
+            "      --csv                  Output every sample as a CSV row, the\n"
+            "                             environment as leading # comments\n"
+            "      --output=FILE          Write the results to FILE instead of stdout\n"
+            "      --baseline=FILE        Compare with the samples of a previous run\n"
+            "                             saved with --csv, report speedups and\n"
+            "                             Mann-Whitney p-values, exit with status 2\n"
+            "                             if some value significantly regressed.\n"
+            "                             Needs --trials=4 or more, and as many\n"
+            "                             samples of every value in the baseline:\n"
+            "                             fewer are never significant\n"
+            "      --regress-threshold=PCT\n"
+            "                             Only report slowdowns by more than PCT\n"
+            "                             percent as regressions (default: 5)\n"
+            "      --trials=N             Run every test N times and report statistics\n"
+            "                             over the samples\n"
+            "      --target-ci=PCT        Run more trials until the confidence interval\n"
+            "                             of the median is narrower than PCT percent\n"
+            "                             of the median\n"
+            "      --max-trials=N         Upper bound on the number of trials in\n"
+            "                             --target-ci mode (default: 100)\n"
+            "      --warmup=N             Run N discarded trials before measuring\n"
+            "      --warmup-time=SEC      Run discarded trials for at least SEC seconds\n"
+            "                             before measuring\n"
+            "      --cache=MODE           hot (default), cold or both. Cold trials are\n"
+            "                             preceded by evicting the data caches\n"
+            "      --flush-size=MB        Size of the buffer used to evict the caches\n"
+            "                             (default: twice the last level cache)\n"
+            "      --perf                 Collect hardware performance counters and\n"
+            "                             report IPC and misses per operation\n"
+            "      --clock=CLOCK          Timestamps for multiparam tests: chrono\n"
+            "                             (default) or tsc (needs an invariant TSC)\n"
+            "      --self-test            Measure the overhead of the multiparam\n"
+            "                             instrumentation and exit\n"
+            "      --histogram            Record latencies of single invocations of\n"
+            "                             multiparam tests, report their percentiles\n"
+            "      --isolate              Run every test on every solution in a\n"
+            "                             separate process, report the growth of\n"
+            "                             the peak RSS over the memory shared with\n"
+            "                             the parent, page faults and context\n"
+            "                             switches\n"
+            "  -j  --jobs=N               Run N cells concurrently on worker threads\n"
+            "                             pinned to distinct cores (0: one per\n"
+            "                             physical core, default: 1)\n"
+            "      --memory               Report the peak heap footprint and the\n"
+            "                             bytes per element at the checkpoints of\n"
+            "                             the testers. Slows down the measured code\n"
+            "      --threads=K            Also run every cell on K threads at once,\n"
+            "                             each with a private copy of the tester;\n"
+            "                             report the aggregate ops/s and the slowdown\n"
+            "                             of a thread against a single one. Needs\n"
+            "                             -j 1: the workers of -j are pinned to one\n"
+            "                             core, which the K threads would share\n"
+            "      --show-empty           Also print the row of the empty solution,\n"
+            "                             which is subtracted from the other rows\n"
+            "      --solution=REGEX       Only run the solutions whose names contain\n"
+            "                             a match of the extended regular expression\n"
+            "      --test=REGEX           Only run the tests whose names contain a\n"
+            "                             match, sweeps are matched by their names\n"
+            "      --list                 List the selected solutions and tests and\n"
+            "                             exit\n"
+            "      --reserve-siblings     Keep hyperthread siblings of the workers'\n"
+            "                             cores idle\n"
+            "      --allocations          Track heap allocations: their number, bytes,\n"
+            "                             peak live bytes and sizes. Slows down the\n"
+            "                             measured code\n"
             "  -h  --help                 Display this help message and exit\n"
             "\n"
             "Copyright (c) 2017-2018 Vasily Alferov\n"
@@ -193,16 +800,147 @@ namespace speedtest {
         std::cout << message << std::endl;
     }
     
+    // Matches "--name=value" options, stores the value.
+    bool parse_value(const char* arg, const char* name, std::string& value) {
+        std::size_t len = std::strlen(name);
+        if (std::strncmp(arg, name, len) != 0 || arg[len] != '=')
+            return false;
+        value = arg + len + 1;
+        return true;
+    }
+
+    int parse_positive_int(const std::string& option, const std::string& value) {
+        int ret = std::atoi(value.c_str());
+        if (ret <= 0) {
+            std::cerr << "Error: " << option << " requires a positive integer" << std::endl;
+            exit(1);
+        }
+        return ret;
+    }
+
+    std::vector<SpeedTestConfig::CacheMode> parse_cache_modes(const std::string& value) {
+        typedef SpeedTestConfig::CacheMode CacheMode;
+        if (value == "hot")
+            return { CacheMode::Hot };
+        if (value == "cold")
+            return { CacheMode::Cold };
+        if (value == "both")
+            return { CacheMode::Hot, CacheMode::Cold };
+        std::cerr << "Error: unknown cache mode " << value << std::endl;
+        exit(1);
+    }
+
+    ClockBackend parse_clock(const std::string& value) {
+        if (value == "chrono")
+            return ClockBackend::Chrono;
+        if (value == "tsc")
+            return ClockBackend::TSC;
+        std::cerr << "Error: unknown clock " << value << std::endl;
+        exit(1);
+    }
+
     void parse_opts(int argc, char* argv[]) {
+        std::string value;
+        std::string baseline_file;
+        bool list = false;
         for (int i = 1; i < argc; i++) {
-            if (std::strcmp(argv[i], "--quiet") == 0)
+            if (parse_value(argv[i], "--trials", value))
+                st_config.trials = parse_positive_int("--trials", value);
+            else if (parse_value(argv[i], "--max-trials", value))
+                st_config.max_trials = parse_positive_int("--max-trials", value);
+            else if (parse_value(argv[i], "--target-ci", value))
+                st_config.target_ci = std::atof(value.c_str()) / 100;
+            else if (parse_value(argv[i], "--warmup", value))
+                st_config.warmup = std::atoi(value.c_str());
+            else if (parse_value(argv[i], "--warmup-time", value))
+                st_config.warmup_time = std::atof(value.c_str());
+            else if (parse_value(argv[i], "--flush-size", value))
+                st_config.flush_size = (std::size_t)parse_positive_int("--flush-size", value) << 20;
+            else if (parse_value(argv[i], "--cache", value))
+                st_config.cache_modes = parse_cache_modes(value);
+            else if (std::strcmp(argv[i], "--perf") == 0)
+                st_config.perf_counters = true;
+            else if (parse_value(argv[i], "--clock", value))
+                st_config.clock = parse_clock(value);
+            else if (std::strcmp(argv[i], "--self-test") == 0)
+                st_config.self_test = true;
+            else if (std::strcmp(argv[i], "--histogram") == 0)
+                st_config.histograms = true;
+            else if (std::strcmp(argv[i], "--isolate") == 0)
+                st_config.isolate = true;
+            else if (parse_value(argv[i], "--jobs", value))
+                st_config.jobs = std::atoi(value.c_str());
+            else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+                st_config.jobs = std::atoi(argv[++i]);
+            else if (std::strcmp(argv[i], "--reserve-siblings") == 0)
+                st_config.reserve_siblings = true;
+            else if (std::strcmp(argv[i], "--allocations") == 0)
+                st_config.track_allocations = true;
+            else if (std::strcmp(argv[i], "--memory") == 0)
+                st_config.memory = true;
+            else if (std::strcmp(argv[i], "--show-empty") == 0)
+                st_config.show_empty = true;
+            else if (parse_value(argv[i], "--threads", value))
+                st_config.threads = parse_positive_int("--threads", value);
+            else if (parse_value(argv[i], "--solution", value))
+                set_filter(solution_filter, "--solution", value);
+            else if (parse_value(argv[i], "--test", value))
+                set_filter(test_filter, "--test", value);
+            else if (std::strcmp(argv[i], "--list") == 0)
+                list = true;
+            else if (std::strcmp(argv[i], "--quiet") == 0)
                 st_config.quiet = true;
             else if (std::strcmp(argv[i], "--plaintext") == 0)
                 st_config.output_method = SpeedTestConfig::OutputMethod::PlainText;
+            else if (std::strcmp(argv[i], "--json") == 0)
+                st_config.output_method = SpeedTestConfig::OutputMethod::JSON;
+            else if (std::strcmp(argv[i], "--csv") == 0)
+                st_config.output_method = SpeedTestConfig::OutputMethod::CSV;
+            else if (parse_value(argv[i], "--output", value))
+                st_config.output_file = value;
+            else if (parse_value(argv[i], "--baseline", value))
+                baseline_file = value;
+            else if (parse_value(argv[i], "--regress-threshold", value))
+                st_config.regress_threshold = std::atof(value.c_str()) / 100;
             else if (std::strcmp(argv[i], "--help") == 0
                      || std::strcmp(argv[i], "-h") == 0)
                 st_config.print_help = true;
         }
+        // The K threads inherit the CPU of a pinned worker and would only time-slice it.
+        if (st_config.threads > 1 && st_config.jobs != 1) {
+            std::cerr << "Error: --threads requires -j 1" << std::endl;
+            exit(1);
+        }
+        if (list) {
+            std::vector<std::string> solutions, tests;
+            st_instance->list(solutions, tests);
+            std::cout << "Solutions:" << std::endl;
+            for (auto& name : solutions)
+                std::cout << "  " << name << std::endl;
+            std::cout << "Tests:" << std::endl;
+            for (auto& name : tests)
+                std::cout << "  " << name << std::endl;
+            exit(0);
+        }
+        if (!baseline_file.empty()) {
+            st_config.baseline = std::make_shared<Baseline>();
+            if (!st_config.baseline->load(baseline_file)) {
+                std::cerr << "Error: cannot load the baseline from " << baseline_file << std::endl;
+                exit(1);
+            }
+            // Otherwise the p-values can't get below the significance level and nothing regresses.
+            if (st_config.trials < min_significant_samples) {
+                std::cerr << "Error: --baseline needs --trials=" << min_significant_samples
+                          << " or more to detect regressions" << std::endl;
+                exit(1);
+            }
+            if (st_config.baseline->min_samples() < (std::size_t)min_significant_samples) {
+                std::cerr << "Error: the baseline " << baseline_file << " has values with fewer than "
+                          << min_significant_samples << " samples, record it with --trials="
+                          << min_significant_samples << " or more" << std::endl;
+                exit(1);
+            }
+        }
     }
     
     void run(int argc, char* argv[]) {
@@ -220,13 +958,179 @@ namespace speedtest {
         case SpeedTestConfig::OutputMethod::PlainText:
             st_config.output.reset(new PlainTextStatOutputMethod());
             break;
+        case SpeedTestConfig::OutputMethod::JSON:
+            st_config.output.reset(new JSONStatOutputMethod());
+            break;
+        case SpeedTestConfig::OutputMethod::CSV:
+            st_config.output.reset(new CSVStatOutputMethod());
+            break;
         default:
             break;
         }
         
+        if (!select_clock(st_config.clock))
+            log_message("Warning: invariant TSC is unavailable, using the chrono clock");
+        if (st_config.self_test) {
+            self_test();
+            exit(0);
+        }
+
+        if (st_config.jobs <= 0)
+            st_config.jobs = Scheduler::worker_cpus(true).size();
+        if (st_config.track_allocations || st_config.memory)
+            enable_allocation_tracking();
+
+        // Fail before running the tests rather than after.
+        std::ofstream output_file;
+        if (!st_config.output_file.empty()) {
+            output_file.open(st_config.output_file);
+            if (!output_file) {
+                std::cerr << "Error: cannot open " << st_config.output_file << std::endl;
+                exit(1);
+            }
+        }
+
         st_instance->setup();
         st_instance->run();
+
+        // Output methods write to std::cout.
+        std::streambuf* stdout_buf = std::cout.rdbuf();
+        if (output_file.is_open())
+            std::cout.rdbuf(output_file.rdbuf());
         st_config.output->flush();
+        std::cout.rdbuf(stdout_buf);
+
+        if (st_config.regressions > 0) {
+            log_message("Error: " + std::to_string(st_config.regressions) + " significant regressions");
+            exit(2);
+        }
+    }
+
+    void check_regressions(const std::deque<TestResultPtr>& results) {
+        for (auto& res : results) {
+            if (!res->exec_result)
+                continue;
+            for (auto& value : res->measured_samples()) {
+                Comparison cmp = st_config.compare_to_baseline(*res, value.first, value.second);
+                if (!cmp.regressed(st_config.regress_threshold))
+                    continue;
+                st_config.regressions++;
+                std::ostringstream ss;
+                ss << "Regression: solution " << res->solution_name << " on test " << res->test_name;
+                if (!value.first.empty())
+                    ss << " (" << value.first << ")";
+                ss << ": speedup " << cmp.speedup << ", p = " << cmp.p_value;
+                log_message(ss.str());
+            }
+        }
+    }
+
+    namespace {
+        std::size_t last_level_cache_size() {
+            long ret = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+            ret = sysconf(_SC_LEVEL3_CACHE_SIZE);
+            if (ret <= 0)
+                ret = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+            if (ret <= 0)
+                ret = 32l << 20;
+            return ret;
+        }
+    };
+
+    void flush_caches() {
+        // Workers flushing at the same time must not share the buffer.
+        static thread_local std::vector<char> buffer;
+        if (buffer.empty()) {
+            std::size_t size = st_config.flush_size;
+            if (size == 0)
+                size = 2 * last_level_cache_size();
+            buffer.resize(size);
+        }
+        // Writing every cache line makes the previous contents get evicted even
+        // on caches that only allocate lines on writes.
+        const std::size_t line = 64;
+        volatile char sink = 0;
+        for (std::size_t i = 0; i < buffer.size(); i += line) {
+            buffer[i]++;
+            sink += buffer[i];
+        }
+        (void)sink;
+    }
+
+    namespace {
+        void save_string(std::ostream& out, const std::string& str) {
+            out << str.size() << ' ' << str << ' ';
+        }
+
+        bool load_string(std::istream& in, std::string& str) {
+            std::size_t len;
+            if (!(in >> len) || in.get() != ' ')
+                return false;
+            str.resize(len);
+            return len == 0 || in.read(&str[0], len);
+        }
+
+        void save_samples(std::ostream& out, const Samples& samples) {
+            out << samples.size();
+            for (auto sample : samples)
+                out << ' ' << sample.count();
+            out << ' ';
+        }
+
+        bool load_samples(std::istream& in, Samples& samples) {
+            std::size_t n;
+            if (!(in >> n))
+                return false;
+            samples.resize(n);
+            for (auto& sample : samples) {
+                long long ns;
+                if (!(in >> ns))
+                    return false;
+                sample = std::chrono::nanoseconds(ns);
+            }
+            return true;
+        }
+
+        void save_counters(std::ostream& out, const CounterValues& counters) {
+            for (int i = 0; i < CounterValues::NumEvents; i++)
+                out << counters.valid[i] << ' ' << counters.value[i] << ' ';
+        }
+
+        bool load_counters(std::istream& in, CounterValues& counters) {
+            for (int i = 0; i < CounterValues::NumEvents; i++) {
+                if (!(in >> counters.valid[i] >> counters.value[i]))
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    void BasicTestResult::save(std::ostream& out) const {
+        out.precision(17);
+        out << exec_result << ' ' << usage.valid << ' ' << usage.max_rss << ' '
+            << usage.minor_faults << ' ' << usage.major_faults << ' '
+            << usage.voluntary_switches << ' ' << usage.involuntary_switches << ' ';
+        allocations.save(out);
+        out << contention.valid << ' ' << contention.threads << ' ' << contention.single_seconds << ' '
+            << contention.thread_seconds << ' ' << contention.wall_seconds << ' ' << contention.ops_per_trial << ' ';
+    }
+
+    bool BasicTestResult::load(std::istream& in) {
+        return (in >> exec_result >> usage.valid >> usage.max_rss
+                   >> usage.minor_faults >> usage.major_faults
+                   >> usage.voluntary_switches >> usage.involuntary_switches)
+            && allocations.load(in)
+            && (in >> contention.valid >> contention.threads >> contention.single_seconds
+                   >> contention.thread_seconds >> contention.wall_seconds >> contention.ops_per_trial);
+    }
+
+    double BasicTestResult::trial_seconds() const {
+        double ret = 0;
+        for (auto& value : measured_samples())
+            ret += (double)median(value.second).count() / 1e9;
+        return ret;
     }
 
     void SingleTestResult::print_test(StatOutputMethod &stat_output) {
@@ -235,22 +1139,137 @@ namespace speedtest {
 
     void SingleTestResult::remove_empty_solution_difference(const std::shared_ptr<BasicTestResult> &d) {
         if (d.get() != nullptr) {
+            allocations.remove_baseline(d->allocations);
             std::shared_ptr<SingleTestResult> str = std::dynamic_pointer_cast<SingleTestResult, BasicTestResult>(d);
-            exec_time -= str->exec_time;
-            exec_time = std::max(std::chrono::nanoseconds(0), exec_time);
+            for (auto& sample : samples)
+                sample = std::max(std::chrono::nanoseconds(0), sample - str->exec_time);
+            exec_time = median(samples);
+            counters.remove_baseline(str->counters, str->ops, ops);
         }
     }
 
+    void SingleTestResult::add_trial(const BasicTestResult& trial) {
+        const SingleTestResult& str = dynamic_cast<const SingleTestResult&>(trial);
+        exec_result = exec_result && str.exec_result;
+        // Every trial does the same work, so the allocations of the first one are kept.
+        if (!allocations.valid)
+            allocations = str.allocations;
+        samples.insert(samples.end(), str.samples.begin(), str.samples.end());
+        exec_time = median(samples);
+        counters += str.counters;
+        ops += str.ops;
+    }
+
+    void SingleTestResult::save(std::ostream& out) const {
+        BasicTestResult::save(out);
+        save_samples(out, samples);
+        save_counters(out, counters);
+        out << ops << ' ';
+    }
+
+    bool SingleTestResult::load(std::istream& in) {
+        if (!BasicTestResult::load(in) || !load_samples(in, samples)
+            || !load_counters(in, counters) || !(in >> ops))
+            return false;
+        exec_time = median(samples);
+        return true;
+    }
+
+    std::map<std::string, Samples> SingleTestResult::measured_samples() const {
+        return { { "", samples } };
+    }
+
+    long long SingleTestResult::ops_per_trial() const {
+        return 1;
+    }
+
+    int SingleTestResult::num_trials() const {
+        return samples.size();
+    }
+
+    double SingleTestResult::relative_ci_width() const {
+        return compute_stats(samples).relative_ci_width();
+    }
+
     void MultitestResult::print_test(StatOutputMethod &stat_output) {
         stat_output.print_multitest_result(*this);
     }
 
     void MultitestResult::remove_empty_solution_difference(const std::shared_ptr<BasicTestResult> &d) {
         if (d.get() != nullptr) {
+            allocations.remove_baseline(d->allocations);
             std::shared_ptr<MultitestResult> str = std::dynamic_pointer_cast<MultitestResult, BasicTestResult>(d);
-            exec_time -= str->exec_time;
-            exec_time = std::max(std::chrono::nanoseconds(0), exec_time);
+            for (auto& sample : samples)
+                sample = std::max(std::chrono::nanoseconds(0), sample - str->exec_time);
+            exec_time = median(samples);
+            counters.remove_baseline(str->counters, str->ops, ops);
+        }
+    }
+
+    void MultitestResult::add_trial(const BasicTestResult& trial) {
+        const MultitestResult& str = dynamic_cast<const MultitestResult&>(trial);
+        exec_result = exec_result && str.exec_result;
+        // Every trial does the same work, so the allocations of the first one are kept.
+        if (!allocations.valid)
+            allocations = str.allocations;
+        samples.insert(samples.end(), str.samples.begin(), str.samples.end());
+        exec_time = median(samples);
+        counters += str.counters;
+        ops += str.ops;
+    }
+
+    void MultitestResult::save(std::ostream& out) const {
+        BasicTestResult::save(out);
+        out << test_num << ' ';
+        save_samples(out, samples);
+        save_counters(out, counters);
+        out << ops << ' ';
+    }
+
+    bool MultitestResult::load(std::istream& in) {
+        if (!BasicTestResult::load(in) || !(in >> test_num) || !load_samples(in, samples)
+            || !load_counters(in, counters) || !(in >> ops))
+            return false;
+        exec_time = median(samples);
+        return true;
+    }
+
+    std::map<std::string, Samples> MultitestResult::measured_samples() const {
+        return { { "", samples } };
+    }
+
+    long long MultitestResult::ops_per_trial() const {
+        return test_num;
+    }
+
+    int MultitestResult::num_trials() const {
+        return samples.size();
+    }
+
+    double MultitestResult::relative_ci_width() const {
+        return compute_stats(samples).relative_ci_width();
+    }
+
+    void MultiparamTestResult::start_trial(const std::vector<std::string>& params) {
+        slots.assign(params.size(), ParamSlot());
+        if (st_config.histograms)
+            slot_histograms.assign(params.size(), LatencyHistogram());
+    }
+
+    void MultiparamTestResult::finish_trial(const std::vector<std::string>& params) {
+        for (std::size_t i = 0; i < params.size(); i++) {
+            const std::string& param = params[i];
+            ParamSlot& slot = slots[i];
+            exec_time[param] = ticks_to_ns(slot.ticks);
+            samples[param].push_back(exec_time[param]);
+            invocations[param] += slot.invocations;
+            if (st_config.perf_counters)
+                counters[param] += slot.counters;
+            if (st_config.histograms)
+                histograms[param].add(slot_histograms[i]);
         }
+        slots.clear();
+        slot_histograms.clear();
     }
 
     void MultiparamTestResult::print_test(StatOutputMethod &stat_output) {
@@ -259,20 +1278,90 @@ namespace speedtest {
 
     void MultiparamTestResult::remove_empty_solution_difference(const std::shared_ptr<BasicTestResult> &d) {
         if (d.get() != nullptr) {
+            allocations.remove_baseline(d->allocations);
             std::shared_ptr<MultiparamTestResult> str = std::dynamic_pointer_cast<MultiparamTestResult,
                                                                                   BasicTestResult      >(d);
-            std::vector<std::string> all_params;
-            for (auto p : exec_time)
-                all_params.push_back(p.first);
-            for (auto p : exec_time)
-                all_params.push_back(p.first);
-            std::sort(all_params.begin(), all_params.end());
-            all_params.resize(std::unique(all_params.begin(), all_params.end()) - all_params.begin());
-
-            for (auto param : all_params) {
-                exec_time[param] -= str->exec_time[param];
-                exec_time[param] = std::max(std::chrono::nanoseconds(0), exec_time[param]);
+            for (auto& p : samples) {
+                std::chrono::nanoseconds empty_time = str->exec_time[p.first];
+                for (auto& sample : p.second)
+                    sample = std::max(std::chrono::nanoseconds(0), sample - empty_time);
+                exec_time[p.first] = median(p.second);
             }
+            for (auto& p : counters)
+                p.second.remove_baseline(str->counters[p.first], str->invocations[p.first], invocations[p.first]);
+        }
+    }
+
+    void MultiparamTestResult::add_trial(const BasicTestResult& trial) {
+        const MultiparamTestResult& str = dynamic_cast<const MultiparamTestResult&>(trial);
+        exec_result = exec_result && str.exec_result;
+        // Every trial does the same work, so the allocations of the first one are kept.
+        if (!allocations.valid)
+            allocations = str.allocations;
+        for (auto& p : str.samples) {
+            Samples& w = samples[p.first];
+            w.insert(w.end(), p.second.begin(), p.second.end());
+            exec_time[p.first] = median(w);
+        }
+        for (auto& p : str.counters)
+            counters[p.first] += p.second;
+        for (auto& p : str.invocations)
+            invocations[p.first] += p.second;
+        for (auto& p : str.histograms)
+            histograms[p.first].add(p.second);
+    }
+
+    void MultiparamTestResult::save(std::ostream& out) const {
+        BasicTestResult::save(out);
+        out << samples.size() << ' ';
+        for (auto& p : samples) {
+            save_string(out, p.first);
+            save_samples(out, p.second);
+            auto c = counters.find(p.first);
+            save_counters(out, c == counters.end() ? CounterValues() : c->second);
+            auto i = invocations.find(p.first);
+            out << (i == invocations.end() ? 0 : i->second) << ' ';
+            auto h = histograms.find(p.first);
+            (h == histograms.end() ? LatencyHistogram() : h->second).save(out);
+        }
+    }
+
+    bool MultiparamTestResult::load(std::istream& in) {
+        std::size_t n;
+        if (!BasicTestResult::load(in) || !(in >> n))
+            return false;
+        for (std::size_t i = 0; i < n; i++) {
+            std::string param;
+            if (!load_string(in, param) || !load_samples(in, samples[param])
+                || !load_counters(in, counters[param]) || !(in >> invocations[param])
+                || !histograms[param].load(in))
+                return false;
+            exec_time[param] = median(samples[param]);
         }
+        return true;
+    }
+
+    std::map<std::string, Samples> MultiparamTestResult::measured_samples() const {
+        return samples;
+    }
+
+    long long MultiparamTestResult::ops_per_trial() const {
+        long long ret = 0;
+        for (auto& p : invocations)
+            ret += p.second;
+        return num_trials() > 0 ? ret / num_trials() : 0;
+    }
+
+    int MultiparamTestResult::num_trials() const {
+        if (samples.empty())
+            return 1;
+        return samples.begin()->second.size();
+    }
+
+    double MultiparamTestResult::relative_ci_width() const {
+        double ret = 0;
+        for (auto& p : samples)
+            ret = std::max(ret, compute_stats(p.second).relative_ci_width());
+        return ret;
     }
 };
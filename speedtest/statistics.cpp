@@ -0,0 +1,150 @@
+// -*- mode: c++; -*-
+/*
+ * Copyright (c) 2017-2018 Vasily Alferov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <speedtest/statistics.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace speedtest {
+    namespace {
+        double sorted_median(const std::vector<double>& w) {
+            std::size_t n = w.size();
+            if (n == 0)
+                return 0;
+            if (n % 2 == 1)
+                return w[n / 2];
+            return (w[n / 2 - 1] + w[n / 2]) / 2;
+        }
+
+        double median_of(std::vector<double> w) {
+            std::sort(w.begin(), w.end());
+            return sorted_median(w);
+        }
+    };
+
+    double SampleStats::relative_ci_width() const {
+        if (median == 0)
+            return 0;
+        return (ci_high - ci_low) / median;
+    }
+
+    std::chrono::nanoseconds median(Samples samples) {
+        if (samples.empty())
+            return std::chrono::nanoseconds(0);
+        std::sort(samples.begin(), samples.end());
+        std::size_t n = samples.size();
+        if (n % 2 == 1)
+            return samples[n / 2];
+        return (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    }
+
+    SampleStats compute_stats(const Samples& samples) {
+        SampleStats ret;
+        ret.count = samples.size();
+        if (samples.empty())
+            return ret;
+
+        std::vector<double> w;
+        for (auto s : samples)
+            w.push_back((double)s.count() / 1e9);
+        std::sort(w.begin(), w.end());
+
+        ret.min = w.front();
+        ret.median = sorted_median(w);
+        double sum = 0;
+        for (double x : w)
+            sum += x;
+        ret.mean = sum / w.size();
+        if (w.size() > 1) {
+            double sq = 0;
+            for (double x : w)
+                sq += (x - ret.mean) * (x - ret.mean);
+            ret.stddev = std::sqrt(sq / (w.size() - 1));
+        }
+        std::vector<double> dev;
+        for (double x : w)
+            dev.push_back(std::abs(x - ret.median));
+        ret.mad = median_of(dev);
+
+        ret.ci_low = ret.ci_high = ret.median;
+        if (w.size() > 1) {
+            // The generator is seeded with a constant, so the reported interval
+            // does not change between two outputs of the same samples.
+            std::mt19937 rnd(179);
+            std::uniform_int_distribution<std::size_t> pick(0, w.size() - 1);
+            std::vector<double> medians(bootstrap_resamples);
+            std::vector<double> resample(w.size());
+            for (int i = 0; i < bootstrap_resamples; i++) {
+                for (std::size_t j = 0; j < w.size(); j++)
+                    resample[j] = w[pick(rnd)];
+                medians[i] = median_of(resample);
+            }
+            std::sort(medians.begin(), medians.end());
+            double alpha = (1 - ci_level) / 2;
+            ret.ci_low = medians[(std::size_t)(alpha * (bootstrap_resamples - 1))];
+            ret.ci_high = medians[(std::size_t)((1 - alpha) * (bootstrap_resamples - 1))];
+        }
+        return ret;
+    }
+
+    double mann_whitney_p(const Samples& a, const Samples& b) {
+        std::size_t n1 = a.size(), n2 = b.size(), n = n1 + n2;
+        if (n1 == 0 || n2 == 0)
+            return 1;
+
+        // Pairs of a value and whether it is from a.
+        std::vector<std::pair<std::chrono::nanoseconds, bool> > all;
+        for (auto s : a)
+            all.emplace_back(s, true);
+        for (auto s : b)
+            all.emplace_back(s, false);
+        std::sort(all.begin(), all.end());
+
+        // Tied values get the average of their ranks.
+        double rank_sum = 0;
+        double ties = 0;
+        for (std::size_t i = 0; i < n; ) {
+            std::size_t j = i;
+            while (j < n && all[j].first == all[i].first)
+                j++;
+            double rank = (double)(i + 1 + j) / 2;
+            for (std::size_t k = i; k < j; k++) {
+                if (all[k].second)
+                    rank_sum += rank;
+            }
+            double t = j - i;
+            ties += t * t * t - t;
+            i = j;
+        }
+
+        double u = rank_sum - (double)n1 * (n1 + 1) / 2;
+        double mean = (double)n1 * n2 / 2;
+        double var = (double)n1 * n2 / 12 * ((n + 1) - ties / ((double)n * (n - 1)));
+        if (var <= 0)
+            return 1;
+        double z = std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(var);
+        return std::erfc(z / std::sqrt(2.0));
+    }
+};
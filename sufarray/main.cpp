@@ -22,6 +22,7 @@
  */
 
 #include <speedtest/speedtest.h>
+#include <speedtest/sweep.h>
 
 #include <tests/random_str.h>
 #include <tests/ordered.h>
@@ -36,7 +37,9 @@ int main(int argc, char *argv[]) {
     speedtest::init(speedtest::testers(
                         random_str(179, test_size),
                         ordered(179, test_size),
-                        reversed(179, test_size)),
+                        reversed(179, test_size),
+                        speedtest::sweep("random_str", 1 << 12, 1 << 20, 4,
+                                         [](long long n) { return random_str(179, n); })),
                     speedtest::solutions<
                         nlog2_hashes<std_sort>,
                         nlog2_hashes<std_stable_sort>,